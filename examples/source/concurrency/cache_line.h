@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstddef>
+
+/*
+Size used to keep data written by different threads on different cache lines.
+
+std::hardware_destructive_interference_size would be the standard way to get
+this, but GCC warns when it is used in a header since its value may change
+with compiler version and -mtune, which would make the layout of types using
+it differ between translation units. 64 bytes is correct for all current
+x86-64 CPUs and most ARM cores.
+*/
+constexpr std::size_t CACHE_LINE_SIZE {64};
+
+/// A T alone on its own cache line.
+template <typename T>
+struct alignas(CACHE_LINE_SIZE) CacheLinePadded
+{
+	T value;
+};
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <latch>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+A fixed-size pool of worker threads sharing a single task queue.
+
+Tasks are type-erased into std::function, which means an allocation for
+captures that don't fit the small buffer. That is fine for the coarse-grained
+tasks this pool is meant for, one task per chunk of a large range, but not
+for per-element work.
+
+Tasks must not block waiting for other tasks in the same pool. With every
+worker blocked there is no one left to run the task being waited for.
+*/
+
+class ThreadPool
+{
+public:
+	static int defaultNumThreads()
+	{
+		// hardware_concurrency may return 0 if the value isn't computable.
+		const unsigned int num_threads = std::thread::hardware_concurrency();
+		return num_threads == 0 ? 1 : static_cast<int>(num_threads);
+	}
+
+	explicit ThreadPool(int num_threads = defaultNumThreads())
+	{
+		m_threads.reserve(static_cast<std::size_t>(num_threads));
+		for (int i = 0; i < num_threads; ++i)
+		{
+			m_threads.emplace_back([this]() { workerLoop(); });
+		}
+	}
+
+	~ThreadPool()
+	{
+		{
+			std::lock_guard lock(m_mutex);
+			m_stopping = true;
+		}
+		m_task_available.notify_all();
+		for (std::thread& thread : m_threads)
+		{
+			thread.join();
+		}
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	int numThreads() const
+	{
+		return static_cast<int>(m_threads.size());
+	}
+
+	void submit(std::function<void()> task)
+	{
+		{
+			std::lock_guard lock(m_mutex);
+			m_tasks.push_back(std::move(task));
+		}
+		m_task_available.notify_one();
+	}
+
+	/// Call 'function(task)' for every task in [0, num_tasks) and block until
+	/// all of them have finished.
+	template <typename Function>
+	void parallelFor(std::ptrdiff_t num_tasks, Function function)
+	{
+		if (num_tasks <= 0)
+		{
+			return;
+		}
+
+		std::latch done(num_tasks);
+		for (std::ptrdiff_t task = 0; task < num_tasks; ++task)
+		{
+			submit([&function, &done, task]() {
+				function(task);
+				done.count_down();
+			});
+		}
+		done.wait();
+	}
+
+private:
+	void workerLoop()
+	{
+		while (true)
+		{
+			std::function<void()> task;
+			{
+				std::unique_lock lock(m_mutex);
+				m_task_available.wait(lock, [this]() { return m_stopping || !m_tasks.empty(); });
+				if (m_tasks.empty())
+				{
+					// Only get here when stopping, and all remaining work is done.
+					return;
+				}
+				task = std::move(m_tasks.front());
+				m_tasks.pop_front();
+			}
+			task();
+		}
+	}
+
+private:
+	std::vector<std::thread> m_threads;
+	std::deque<std::function<void()>> m_tasks;
+	std::mutex m_mutex;
+	std::condition_variable m_task_available;
+	bool m_stopping {false};
+};
@@ -0,0 +1,338 @@
+#pragma once
+
+#include "cache_line.h"
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <thread>
+#include <type_traits>
+
+/*
+A bounded multi-producer multi-consumer work queue with priorities and epochs.
+
+This is the concurrent replacement for the 'work' loop in
+safety/iterator_invalidation.cpp. That loop pushes a sentinel into a
+std::vector, lets 'collect_work' append more work, and pops until it finds the
+sentinel again, which only works because nothing reallocates the vector in
+between and nothing reorders it. Here:
+
+- Storage never moves. Every priority level has a fixed-size ring buffer
+  allocated up front, a full queue rejects new work instead of growing.
+- Priorities are explicit. Work is popped from the highest priority level that
+  has any, there is no sorting.
+- The end of a round of work is an epoch, not a value in the data. Every item
+  is tagged with the epoch it was pushed in. 'closeEpoch' starts a new epoch
+  and returns the old one, and 'isDone(epoch)' becomes true once every item of
+  that epoch has been popped and marked as finished.
+
+Each ring buffer is the bounded MPMC queue by Dmitry Vyukov: every cell has a
+sequence number that tells producers and consumers whose turn it is, and a
+position is claimed with one compare-and-swap. No locks, and producers and
+consumers only contend on the cells they actually touch. A batch of N items is
+claimed with a single compare-and-swap as well, by checking that the next N
+cells are all ready before moving the position past them.
+
+'isDone' and 'drainUntilDone' count outstanding items per epoch in a small ring
+of counters, so at most MAX_OPEN_EPOCHS epochs may have unfinished work at any
+time.
+*/
+
+template <typename T, int NumPriorities = 4>
+class WorkQueue
+{
+	static_assert(NumPriorities > 0);
+	static_assert(std::is_default_constructible_v<T> && std::is_nothrow_move_assignable_v<T>);
+
+public:
+	static constexpr int NUM_PRIORITIES {NumPriorities};
+	static constexpr std::uint64_t MAX_OPEN_EPOCHS {64};
+
+	/// An item popped from the queue, along with the epoch it was pushed in.
+	struct Item
+	{
+		T value;
+		std::uint64_t epoch {0};
+	};
+
+	/// 'capacity' is per priority level and is rounded up to a power of two.
+	explicit WorkQueue(std::ptrdiff_t capacity)
+	{
+		for (CacheLinePadded<Ring>& ring : m_rings)
+		{
+			ring.value.init(capacity);
+		}
+	}
+
+	WorkQueue(const WorkQueue&) = delete;
+	WorkQueue& operator=(const WorkQueue&) = delete;
+
+	std::uint64_t currentEpoch() const
+	{
+		return m_epoch.value.load();
+	}
+
+	/// End the current epoch and start a new one. Returns the epoch that ended,
+	/// no more items will be added to it.
+	std::uint64_t closeEpoch()
+	{
+		return m_epoch.value.fetch_add(1);
+	}
+
+	/// Push 'value' with 'priority', in [0, NUM_PRIORITIES), higher first.
+	/// Returns false if that priority level is full.
+	bool push(T value, int priority = 0)
+	{
+		return pushBatch(std::span<T>(&value, 1), priority) == 1;
+	}
+
+	/// Push as many of 'values' as fit, in order, all in the same epoch.
+	/// Returns the number pushed. The pushed values are moved from.
+	std::ptrdiff_t pushBatch(std::span<T> values, int priority = 0)
+	{
+		assert(priority >= 0 && priority < NUM_PRIORITIES);
+		if (values.empty())
+		{
+			return 0;
+		}
+
+		const auto num_values = static_cast<std::int64_t>(values.size());
+		const std::uint64_t epoch = registerPending(num_values);
+		const std::ptrdiff_t num_pushed = m_rings[priority].value.push(values, epoch);
+		if (num_pushed < num_values)
+		{
+			pending(epoch).fetch_sub(num_values - num_pushed);
+		}
+		return num_pushed;
+	}
+
+	/// Pop the highest priority item, if any. The item counts as outstanding
+	/// for its epoch until 'finish' is called for it.
+	bool tryPop(Item& item)
+	{
+		return popBatch(std::span<Item>(&item, 1)) == 1;
+	}
+
+	/// Pop up to 'items.size()' items, highest priority first. Returns the
+	/// number popped.
+	std::ptrdiff_t popBatch(std::span<Item> items)
+	{
+		std::ptrdiff_t num_popped {0};
+		for (int priority = NUM_PRIORITIES - 1;
+			 priority >= 0 && num_popped < std::ssize(items); --priority)
+		{
+			num_popped += m_rings[priority].value.pop(items.subspan(num_popped));
+		}
+		return num_popped;
+	}
+
+	/// Mark a popped item as processed.
+	void finish(const Item& item)
+	{
+		pending(item.epoch).fetch_sub(1);
+	}
+
+	void finish(std::span<const Item> items)
+	{
+		for (const Item& item : items)
+		{
+			finish(item);
+		}
+	}
+
+	/// True when 'epoch' has been closed and all of its items are finished.
+	bool isDone(std::uint64_t epoch) const
+	{
+		return epoch < currentEpoch() && pendingCount(epoch) == 0;
+	}
+
+	/// Help process work until 'epoch' is done. 'process(value)' is called for
+	/// every item popped, which may belong to any epoch.
+	template <typename Process>
+	void drainUntilDone(std::uint64_t epoch, Process process)
+	{
+		Item item;
+		while (!isDone(epoch))
+		{
+			if (tryPop(item))
+			{
+				process(item.value);
+				finish(item);
+			}
+			else
+			{
+				// Another thread holds the last items of the epoch.
+				std::this_thread::yield();
+			}
+		}
+	}
+
+private:
+	class Ring
+	{
+	public:
+		void init(std::ptrdiff_t capacity)
+		{
+			std::size_t size {1};
+			while (size < static_cast<std::size_t>(capacity))
+			{
+				size *= 2;
+			}
+			m_mask = size - 1;
+			m_cells = std::make_unique<Cell[]>(size);
+			for (std::size_t i = 0; i < size; ++i)
+			{
+				m_cells[i].sequence.store(i, std::memory_order_relaxed);
+			}
+		}
+
+		std::ptrdiff_t push(std::span<T> values, std::uint64_t epoch)
+		{
+			std::size_t position = m_enqueue_position.value.load(std::memory_order_relaxed);
+			std::size_t count {0};
+			for (;;)
+			{
+				// Cell 'position + i' is free for this lap when its sequence is
+				// 'position + i'. Only the producer that claims that position
+				// changes it, so the check holds until the compare-and-swap.
+				count = 0;
+				while (count < values.size() &&
+					   cell(position + count).sequence.load(std::memory_order_acquire) ==
+						   position + count)
+				{
+					++count;
+				}
+				if (count == 0)
+				{
+					const std::size_t sequence = cell(position).sequence.load(std::memory_order_acquire);
+					if (static_cast<std::ptrdiff_t>(sequence - position) < 0)
+					{
+						// The consumers haven't freed the cell from the previous lap, full.
+						return 0;
+					}
+					// Another producer claimed 'position', try again from the new one.
+					position = m_enqueue_position.value.load(std::memory_order_relaxed);
+					continue;
+				}
+				if (m_enqueue_position.value.compare_exchange_weak(
+						position, position + count, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				Cell& target = cell(position + i);
+				target.item.value = std::move(values[i]);
+				target.item.epoch = epoch;
+				target.sequence.store(position + i + 1, std::memory_order_release);
+			}
+			return static_cast<std::ptrdiff_t>(count);
+		}
+
+		std::ptrdiff_t pop(std::span<Item> items)
+		{
+			if (items.empty())
+			{
+				return 0;
+			}
+
+			std::size_t position = m_dequeue_position.value.load(std::memory_order_relaxed);
+			std::size_t count {0};
+			for (;;)
+			{
+				// Cell 'position + i' holds an item when its sequence is
+				// 'position + i + 1'.
+				count = 0;
+				while (count < items.size() &&
+					   cell(position + count).sequence.load(std::memory_order_acquire) ==
+						   position + count + 1)
+				{
+					++count;
+				}
+				if (count == 0)
+				{
+					const std::size_t sequence = cell(position).sequence.load(std::memory_order_acquire);
+					if (static_cast<std::ptrdiff_t>(sequence - (position + 1)) < 0)
+					{
+						// Nothing pushed at 'position' yet, empty.
+						return 0;
+					}
+					position = m_dequeue_position.value.load(std::memory_order_relaxed);
+					continue;
+				}
+				if (m_dequeue_position.value.compare_exchange_weak(
+						position, position + count, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				Cell& source = cell(position + i);
+				items[i].value = std::move(source.item.value);
+				items[i].epoch = source.item.epoch;
+				// Free the cell for the producer one lap ahead.
+				source.sequence.store(position + i + m_mask + 1, std::memory_order_release);
+			}
+			return static_cast<std::ptrdiff_t>(count);
+		}
+
+	private:
+		struct Cell
+		{
+			std::atomic<std::size_t> sequence;
+			Item item;
+		};
+
+		Cell& cell(std::size_t position)
+		{
+			return m_cells[position & m_mask];
+		}
+
+		std::unique_ptr<Cell[]> m_cells;
+		std::size_t m_mask {0};
+		CacheLinePadded<std::atomic<std::size_t>> m_enqueue_position {0};
+		CacheLinePadded<std::atomic<std::size_t>> m_dequeue_position {0};
+	};
+
+	std::atomic<std::int64_t>& pending(std::uint64_t epoch)
+	{
+		return m_pending[epoch % MAX_OPEN_EPOCHS].value;
+	}
+
+	std::int64_t pendingCount(std::uint64_t epoch) const
+	{
+		return m_pending[epoch % MAX_OPEN_EPOCHS].value.load();
+	}
+
+	/// Count 'count' items as outstanding in the current epoch and return it.
+	std::uint64_t registerPending(std::int64_t count)
+	{
+		// Increment first, then check that the epoch hasn't been closed in
+		// between. Both are sequentially consistent, so either this sees the
+		// new epoch and retries, or 'closeEpoch' followed by 'isDone' sees the
+		// increment.
+		for (;;)
+		{
+			const std::uint64_t epoch = m_epoch.value.load();
+			pending(epoch).fetch_add(count);
+			if (m_epoch.value.load() == epoch)
+			{
+				return epoch;
+			}
+			pending(epoch).fetch_sub(count);
+		}
+	}
+
+	std::array<CacheLinePadded<Ring>, NumPriorities> m_rings;
+	CacheLinePadded<std::atomic<std::uint64_t>> m_epoch {0};
+	std::array<CacheLinePadded<std::atomic<std::int64_t>>, MAX_OPEN_EPOCHS> m_pending {};
+};
@@ -0,0 +1,235 @@
+#pragma once
+
+#include "cache_line.h"
+#include "thread_pool.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <latch>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+A thread pool where every worker has its own task queue.
+
+With the single shared queue in ThreadPool every worker takes the same lock for
+every task. Here a worker takes tasks from the back of its own queue, the most
+recently added and most likely to still be in cache, and only when its own queue
+is empty does it steal from the front of another worker's queue. Tasks that are
+submitted together in 'parallelFor' are handed out in contiguous blocks, so a
+worker tends to process neighbouring pieces of data.
+
+The per-worker queues are protected by a mutex each. A lock-free Chase-Lev deque
+would avoid the lock, but the lock is uncontended except while stealing, and
+the tasks are meant to be large.
+*/
+
+class WorkStealingPool
+{
+public:
+	explicit WorkStealingPool(int num_threads = ThreadPool::defaultNumThreads())
+	{
+		for (int i = 0; i < num_threads; ++i)
+		{
+			m_workers.push_back(std::make_unique<Worker>());
+		}
+		for (int i = 0; i < num_threads; ++i)
+		{
+			m_workers[static_cast<std::size_t>(i)]->thread =
+				std::thread([this, i]() { workerLoop(i); });
+		}
+	}
+
+	~WorkStealingPool()
+	{
+		{
+			std::lock_guard lock(m_sleep_mutex);
+			m_stopping = true;
+		}
+		m_wake_up.notify_all();
+		for (std::unique_ptr<Worker>& worker : m_workers)
+		{
+			worker->thread.join();
+		}
+	}
+
+	WorkStealingPool(const WorkStealingPool&) = delete;
+	WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+	int numThreads() const
+	{
+		return static_cast<int>(m_workers.size());
+	}
+
+	/// Index of the worker running the calling thread, or -1 when called from a
+	/// thread that isn't a WorkStealingPool worker. Only meaningful for the
+	/// pool that owns the calling thread.
+	static int currentWorker()
+	{
+		return t_current_worker;
+	}
+
+	/// Number of tasks the given worker has taken from other workers' queues.
+	std::ptrdiff_t numSteals(int worker) const
+	{
+		const Worker& target = *m_workers[static_cast<std::size_t>(worker)];
+		return target.num_steals.load(std::memory_order_relaxed);
+	}
+
+	/// Add a task to the queue of the given worker. Any worker may end up
+	/// running it.
+	void submit(int worker, std::function<void()> task)
+	{
+		Worker& target = *m_workers[static_cast<std::size_t>(worker)];
+		{
+			std::lock_guard lock(target.mutex);
+			target.tasks.push_back(std::move(task));
+		}
+		m_num_queued.fetch_add(1, std::memory_order_release);
+		wakeUp();
+	}
+
+	/// Add a task to the calling worker's queue, or to a worker chosen round
+	/// robin when called from outside the pool.
+	void submit(std::function<void()> task)
+	{
+		int worker = currentWorker();
+		if (worker < 0)
+		{
+			worker = static_cast<int>(
+				m_next_worker.fetch_add(1, std::memory_order_relaxed) % m_workers.size());
+		}
+		submit(worker, std::move(task));
+	}
+
+	/// Call 'function(task)' for every task in [0, num_tasks) and block until
+	/// all of them have finished. Worker w initially gets the tasks
+	/// [w * num_tasks / num_threads, (w + 1) * num_tasks / num_threads).
+	/// Must not be called from a task running on this pool: the calling worker
+	/// blocks without running tasks, and the tasks queued to it never run, so
+	/// parallelFor never returns.
+	template <typename Function>
+	void parallelFor(std::ptrdiff_t num_tasks, Function function)
+	{
+		if (num_tasks <= 0)
+		{
+			return;
+		}
+
+		std::latch done(num_tasks);
+		const std::ptrdiff_t num_workers = numThreads();
+		for (std::ptrdiff_t worker = 0; worker < num_workers; ++worker)
+		{
+			const std::ptrdiff_t begin = worker * num_tasks / num_workers;
+			const std::ptrdiff_t end = (worker + 1) * num_tasks / num_workers;
+			Worker& target = *m_workers[static_cast<std::size_t>(worker)];
+			{
+				std::lock_guard lock(target.mutex);
+				for (std::ptrdiff_t task = begin; task < end; ++task)
+				{
+					target.tasks.push_back([&function, &done, task]() {
+						function(task);
+						done.count_down();
+					});
+				}
+			}
+			m_num_queued.fetch_add(end - begin, std::memory_order_release);
+		}
+		{
+			// Taking the lock orders the notify after any worker that just
+			// checked m_num_queued and is about to wait.
+			std::lock_guard lock(m_sleep_mutex);
+		}
+		m_wake_up.notify_all();
+		done.wait();
+	}
+
+private:
+	struct Worker
+	{
+		std::mutex mutex;
+		std::deque<std::function<void()>> tasks;
+		std::atomic<std::ptrdiff_t> num_steals {0};
+		std::thread thread;
+	};
+
+	void wakeUp()
+	{
+		{
+			std::lock_guard lock(m_sleep_mutex);
+		}
+		m_wake_up.notify_one();
+	}
+
+	bool popOwn(int self, std::function<void()>& task)
+	{
+		Worker& worker = *m_workers[static_cast<std::size_t>(self)];
+		std::lock_guard lock(worker.mutex);
+		if (worker.tasks.empty())
+		{
+			return false;
+		}
+		task = std::move(worker.tasks.back());
+		worker.tasks.pop_back();
+		return true;
+	}
+
+	bool steal(int self, std::function<void()>& task)
+	{
+		const int num_workers = numThreads();
+		for (int offset = 1; offset < num_workers; ++offset)
+		{
+			const int victim_index = (self + offset) % num_workers;
+			Worker& victim = *m_workers[static_cast<std::size_t>(victim_index)];
+			std::lock_guard lock(victim.mutex);
+			if (!victim.tasks.empty())
+			{
+				task = std::move(victim.tasks.front());
+				victim.tasks.pop_front();
+				m_workers[static_cast<std::size_t>(self)]->num_steals.fetch_add(
+					1, std::memory_order_relaxed);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void workerLoop(int self)
+	{
+		t_current_worker = self;
+		while (true)
+		{
+			std::function<void()> task;
+			if (popOwn(self, task) || steal(self, task))
+			{
+				m_num_queued.fetch_sub(1, std::memory_order_relaxed);
+				task();
+				continue;
+			}
+
+			std::unique_lock lock(m_sleep_mutex);
+			m_wake_up.wait(lock, [this]() {
+				return m_stopping || m_num_queued.load(std::memory_order_acquire) > 0;
+			});
+			if (m_stopping && m_num_queued.load(std::memory_order_acquire) == 0)
+			{
+				return;
+			}
+		}
+	}
+
+private:
+	static inline thread_local int t_current_worker {-1};
+
+	std::vector<std::unique_ptr<Worker>> m_workers;
+	alignas(CACHE_LINE_SIZE) std::atomic<std::ptrdiff_t> m_num_queued {0};
+	std::atomic<std::size_t> m_next_worker {0};
+	std::mutex m_sleep_mutex;
+	std::condition_variable m_wake_up;
+	bool m_stopping {false};
+};
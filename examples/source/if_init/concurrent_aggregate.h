@@ -0,0 +1,208 @@
+#pragma once
+
+#include "cache_line.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <numeric>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+/*
+Thread-safe containers of ints that can report their sum.
+
+'sum' in if_init.cpp holds a std::mutex for the entire std::accumulate, so
+readers wait for each other as well as for writers, and every read is O(n)
+under the lock. The classes here trade that for different synchronization
+strategies, all with the same interface: push_back, size, and sum.
+
+- SharedMutexAggregate: std::shared_mutex instead of std::mutex. Readers run
+  concurrently with each other, but still walk all elements.
+- SeqLockAggregate: the sum and count are maintained on every push_back and
+  published through a sequence lock. Readers take no lock at all, they read
+  the sequence number, the values, and the sequence number again, and retry if
+  a writer was active in between. A read is O(1) and never blocks a writer.
+- ShardedAggregate: the elements are split across N shards, each with its own
+  mutex, element array, and running partial sum. Writers on different shards
+  don't contend, and a sum is N atomic loads, no locks.
+*/
+
+class SharedMutexAggregate
+{
+public:
+	void push_back(int value)
+	{
+		std::unique_lock lock(m_mutex);
+		m_values.push_back(value);
+	}
+
+	std::ptrdiff_t size() const
+	{
+		std::shared_lock lock(m_mutex);
+		return std::ssize(m_values);
+	}
+
+	long long sum() const
+	{
+		long long sum {0};
+
+		if (std::shared_lock lock(m_mutex); !m_values.empty())
+		{
+			sum = std::accumulate(m_values.begin(), m_values.end(), 0LL, std::plus());
+		}
+
+		return sum;
+	}
+
+private:
+	mutable std::shared_mutex m_mutex;
+	std::vector<int> m_values;
+};
+
+class SeqLockAggregate
+{
+public:
+	/// The sum and size as of the same point in time.
+	struct Snapshot
+	{
+		long long sum {0};
+		std::ptrdiff_t size {0};
+	};
+
+	void push_back(int value)
+	{
+		// Writers are serialized by the mutex, the sequence number is only for
+		// the readers.
+		std::lock_guard lock(m_write_mutex);
+		m_values.push_back(value);
+
+		const std::uint64_t sequence = m_sequence.load(std::memory_order_relaxed);
+		// Odd while writing.
+		m_sequence.store(sequence + 1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		m_sum.store(m_sum.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+		m_size.store(std::ssize(m_values), std::memory_order_relaxed);
+		m_sequence.store(sequence + 2, std::memory_order_release);
+	}
+
+	Snapshot snapshot() const
+	{
+		for (;;)
+		{
+			const std::uint64_t before = m_sequence.load(std::memory_order_acquire);
+			if (before % 2 == 1)
+			{
+				// A writer is in the middle of an update.
+				continue;
+			}
+			Snapshot snapshot {
+				m_sum.load(std::memory_order_relaxed), m_size.load(std::memory_order_relaxed)};
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (m_sequence.load(std::memory_order_relaxed) == before)
+			{
+				return snapshot;
+			}
+		}
+	}
+
+	std::ptrdiff_t size() const
+	{
+		return snapshot().size;
+	}
+
+	long long sum() const
+	{
+		return snapshot().sum;
+	}
+
+private:
+	std::mutex m_write_mutex;
+	std::vector<int> m_values;
+	// Read by the readers without the mutex, hence atomic, even though the
+	// sequence number is what makes the pair consistent.
+	std::atomic<std::uint64_t> m_sequence {0};
+	std::atomic<long long> m_sum {0};
+	std::atomic<std::ptrdiff_t> m_size {0};
+};
+
+template <int NumShards = 16>
+class ShardedAggregate
+{
+	static_assert(NumShards > 0);
+
+public:
+	static constexpr int NUM_SHARDS {NumShards};
+
+	/// Add 'value' to the shard of the calling thread.
+	void push_back(int value)
+	{
+		Shard& shard = m_shards[shardOfThisThread()].value;
+		std::lock_guard lock(shard.mutex);
+		shard.values.push_back(value);
+		// Only this shard's writers, who hold the mutex, modify the partial sum.
+		const long long new_sum = shard.sum.load(std::memory_order_relaxed) + value;
+		shard.sum.store(new_sum, std::memory_order_relaxed);
+		shard.size.store(std::ssize(shard.values), std::memory_order_relaxed);
+	}
+
+	std::ptrdiff_t size() const
+	{
+		std::ptrdiff_t size {0};
+		for (const CacheLinePadded<Shard>& shard : m_shards)
+		{
+			size += shard.value.size.load(std::memory_order_relaxed);
+		}
+		return size;
+	}
+
+	/// O(NUM_SHARDS). Each partial sum is exact, but pushes that happen during
+	/// the call may be counted in some shards and not yet in others.
+	long long sum() const
+	{
+		long long sum {0};
+		for (const CacheLinePadded<Shard>& shard : m_shards)
+		{
+			sum += shard.value.sum.load(std::memory_order_relaxed);
+		}
+		return sum;
+	}
+
+	/// Call 'function(value)' for every element, one shard at a time.
+	template <typename Function>
+	void forEach(Function function) const
+	{
+		for (const CacheLinePadded<Shard>& shard : m_shards)
+		{
+			std::lock_guard lock(shard.value.mutex);
+			for (int value : shard.value.values)
+			{
+				function(value);
+			}
+		}
+	}
+
+private:
+	struct Shard
+	{
+		mutable std::mutex mutex;
+		std::vector<int> values;
+		std::atomic<long long> sum {0};
+		std::atomic<std::ptrdiff_t> size {0};
+	};
+
+	static std::size_t shardOfThisThread()
+	{
+		// Hashed once per thread, threads keep writing to the same shard.
+		thread_local const std::size_t shard =
+			std::hash<std::thread::id>()(std::this_thread::get_id()) % NumShards;
+		return shard;
+	}
+
+private:
+	std::array<CacheLinePadded<Shard>, NumShards> m_shards;
+};
@@ -0,0 +1,134 @@
+#include "concurrent_aggregate.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+// The data/mutex pair and 'sum' from if_init.cpp, wrapped in the same
+// interface as the classes in concurrent_aggregate.h.
+class MutexAggregate
+{
+public:
+	void push_back(int value)
+	{
+		std::lock_guard lock(m_mutex);
+		m_values.push_back(value);
+	}
+
+	long long sum()
+	{
+		long long sum = 0;
+
+		if (std::lock_guard lock(m_mutex); !m_values.empty())
+		{
+			sum = std::accumulate(m_values.begin(), m_values.end(), 0LL, std::plus());
+		}
+
+		return sum;
+	}
+
+private:
+	std::mutex m_mutex;
+	std::vector<int> m_values;
+};
+
+struct Throughput
+{
+	long long num_reads {0};
+	long long num_writes {0};
+	long long final_sum {0};
+	/// Elements are only added, so no reader should ever see the sum shrink.
+	bool sums_increasing {true};
+};
+
+/// Run 'num_readers' threads calling 'sum' and 'num_writers' threads calling
+/// 'push_back' for 'duration' and count how many calls of each got through.
+template <typename Aggregate>
+Throughput measure(int num_readers, int num_writers, std::chrono::milliseconds duration)
+{
+	Aggregate aggregate;
+	// Start with enough elements that an O(n) sum is noticeable.
+	for (int i = 0; i < 100'000; ++i)
+	{
+		aggregate.push_back(1);
+	}
+
+	std::atomic<bool> running {true};
+	std::atomic<long long> num_reads {0};
+	std::atomic<bool> sums_increasing {true};
+	std::atomic<long long> num_writes {0};
+	std::vector<std::thread> threads;
+	for (int reader = 0; reader < num_readers; ++reader)
+	{
+		threads.emplace_back([&]() {
+			long long reads {0};
+			long long previous_sum {0};
+			bool increasing {true};
+			while (running.load(std::memory_order_relaxed))
+			{
+				const long long sum = aggregate.sum();
+				increasing &= sum >= previous_sum;
+				previous_sum = sum;
+				++reads;
+			}
+			num_reads += reads;
+			if (!increasing)
+			{
+				sums_increasing = false;
+			}
+		});
+	}
+	for (int writer = 0; writer < num_writers; ++writer)
+	{
+		threads.emplace_back([&]() {
+			long long writes {0};
+			while (running.load(std::memory_order_relaxed))
+			{
+				aggregate.push_back(1);
+				++writes;
+			}
+			num_writes += writes;
+		});
+	}
+
+	std::this_thread::sleep_for(duration);
+	running = false;
+	for (std::thread& thread : threads)
+	{
+		thread.join();
+	}
+	return {num_reads, num_writes, aggregate.sum(), sums_increasing};
+}
+
+template <typename Aggregate>
+void report(const char* label, int num_readers, int num_writers)
+{
+	const Throughput result =
+		measure<Aggregate>(num_readers, num_writers, std::chrono::milliseconds(250));
+	std::cout << "  " << label << result.num_reads << " sums, " << result.num_writes
+			  << " pushes, sum correct: " << (result.final_sum == 100'000 + result.num_writes)
+			  << ", never decreased: " << result.sums_increasing << '\n';
+}
+
+void readers_and_writers()
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	const int num_readers = std::max(1, static_cast<int>(std::thread::hardware_concurrency()) - 1);
+	const int num_writers {1};
+	std::cout << "  " << num_readers << " readers, " << num_writers << " writer, 250 ms each\n";
+	report<MutexAggregate>("std::mutex:        ", num_readers, num_writers);
+	report<SharedMutexAggregate>("std::shared_mutex: ", num_readers, num_writers);
+	report<SeqLockAggregate>("Sequence lock:     ", num_readers, num_writers);
+	report<ShardedAggregate<>>("Sharded:           ", num_readers, num_writers);
+}
+
+int main()
+{
+	readers_and_writers();
+}
@@ -0,0 +1,123 @@
+#include "rcu_vector.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+// Same as in if_init.cpp.
+int sum(std::vector<int>& container, std::mutex& mutex)
+{
+	int sum = 0;
+
+	if (std::lock_guard lock(mutex); !container.empty())
+	{
+		sum = std::accumulate(container.begin(), container.end(), 0, std::plus());
+	}
+
+	return sum;
+}
+
+void same_as_if_init_cpp()
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	RcuVector data({1, 2, 3, 4});
+	RcuVector::Reader reader(data);
+	std::cout << "  " << sum(data.read(reader)) << '\n';
+
+	// A snapshot is not affected by later writes.
+	RcuVector::Snapshot snapshot = data.read(reader);
+	data.push_back(5);
+	std::cout << "  Snapshot " << sum(snapshot) << ", retired versions " << data.numRetired()
+			  << '\n';
+}
+
+struct Latency
+{
+	double worst_us {0.0};
+	long long num_reads {0};
+	/// Range of the sums read, to see that every read saw a whole version.
+	long long min_sum {std::numeric_limits<long long>::max()};
+	long long max_sum {std::numeric_limits<long long>::min()};
+};
+
+/// Sum in a loop, like a real-time thread polling shared state, while another
+/// thread keeps writing. Returns the slowest single read. Needs at least two
+/// cores to mean anything, otherwise the reader being preempted by the writer
+/// dominates the slowest read either way.
+template <typename ReadSum, typename Write>
+Latency readWhileWriting(ReadSum read_sum, Write write, std::chrono::milliseconds duration)
+{
+	std::atomic<bool> running {true};
+	std::thread writer([&]() {
+		while (running.load(std::memory_order_relaxed))
+		{
+			write();
+		}
+	});
+
+	Latency latency;
+	const auto stop = std::chrono::steady_clock::now() + duration;
+	while (std::chrono::steady_clock::now() < stop)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		const long long read = read_sum();
+		const auto end = std::chrono::steady_clock::now();
+		const double read_us = std::chrono::duration<double, std::micro>(end - start).count();
+		latency.worst_us = std::max(latency.worst_us, read_us);
+		++latency.num_reads;
+		latency.min_sum = std::min(latency.min_sum, read);
+		latency.max_sum = std::max(latency.max_sum, read);
+	}
+
+	running = false;
+	writer.join();
+	return latency;
+}
+
+void real_time_reader()
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	constexpr int num_elements {10'000};
+	const auto duration = std::chrono::milliseconds(250);
+
+	// The writer holds the mutex while it grows the vector, the reader waits.
+	std::vector<int> data(num_elements, 1);
+	std::mutex mutex;
+	const Latency with_mutex = readWhileWriting(
+		[&]() { return sum(data, mutex); },
+		[&]() {
+			std::lock_guard lock(mutex);
+			data.push_back(1);
+			data.pop_back();
+		},
+		duration);
+
+	// The writer copies and publishes, the reader never waits.
+	RcuVector rcu_data(std::vector<int>(num_elements, 1));
+	RcuVector::Reader reader(rcu_data);
+	const Latency with_rcu = readWhileWriting(
+		[&]() { return sum(rcu_data.read(reader)); },
+		[&]() { rcu_data.update([](std::vector<int>& values) { values.back() ^= 1; }); },
+		duration);
+
+	std::cout << "  std::mutex: " << with_mutex.num_reads << " reads, slowest "
+			  << with_mutex.worst_us << " us, sums " << with_mutex.min_sum << ".."
+			  << with_mutex.max_sum << '\n';
+	std::cout << "  RCU:        " << with_rcu.num_reads << " reads, slowest " << with_rcu.worst_us
+			  << " us, sums " << with_rcu.min_sum << ".." << with_rcu.max_sum << '\n';
+	std::cout << "  Retired versions left: " << rcu_data.numRetired() << '\n';
+}
+
+int main()
+{
+	same_as_if_init_cpp();
+	real_time_reader();
+}
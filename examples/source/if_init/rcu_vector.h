@@ -0,0 +1,239 @@
+#pragma once
+
+#include "cache_line.h"
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+/*
+A vector of ints that readers can read without ever blocking.
+
+This is read-copy-update, RCU. A writer never modifies the vector readers see.
+It copies the current version, modifies the copy, and publishes it by swapping
+an atomic pointer. Readers load the pointer and read whichever version they
+get, undisturbed by any writes that happen meanwhile. That makes the read
+path suitable for a real-time thread, such as an audio callback, that may not
+wait for a mutex held by a lower-priority thread. See
+"CppCon 2021 - Real-Time Programming With The C++ Standard Library.md".
+
+The hard part is knowing when an old version can be deleted. A
+std::atomic<std::shared_ptr> would handle that, but libstdc++ implements it
+with a lock, and the last reader to let go of a version would run the delete
+on the real-time thread. Instead the old versions are reclaimed by epochs:
+
+- There is a global epoch counter, bumped every time a version is replaced.
+  The replaced version is retired with the epoch it was replaced in.
+- Every reader has a slot. While reading, the slot holds the epoch the reader
+  saw when it started, otherwise zero.
+- A retired version can be deleted once no slot holds an epoch at or before
+  the one it was retired in. Any reader that started later loaded the newer
+  pointer.
+
+Readers only ever store to their own slot and load atomics, wait-free. All
+allocation and deallocation happens on the writer's thread. Writers are
+serialized by a mutex and each write copies the whole vector, so this is for
+data that is read much more often than it is written.
+*/
+
+class RcuVector
+{
+public:
+	static constexpr int MAX_READERS {64};
+
+	/// A thread's registration as a reader. Create one per reading thread, up
+	/// front, and pass it to every 'read'. Throws std::length_error if
+	/// MAX_READERS readers already exist.
+	class Reader
+	{
+	public:
+		explicit Reader(RcuVector& vector)
+			: m_vector(vector)
+			, m_slot(vector.claimSlot())
+		{
+		}
+
+		~Reader()
+		{
+			m_vector.m_slot_in_use[static_cast<std::size_t>(m_slot)].value.store(false);
+		}
+
+		Reader(const Reader&) = delete;
+		Reader& operator=(const Reader&) = delete;
+
+	private:
+		friend class RcuVector;
+
+		RcuVector& m_vector;
+		int m_slot;
+	};
+
+	/// The version of the vector current when the snapshot was taken. Stays
+	/// valid and unchanged until the snapshot is destroyed.
+	class Snapshot
+	{
+	public:
+		~Snapshot()
+		{
+			m_slot.store(0);
+		}
+
+		Snapshot(const Snapshot&) = delete;
+		Snapshot& operator=(const Snapshot&) = delete;
+
+		std::span<const int> values() const
+		{
+			return *m_values;
+		}
+
+	private:
+		friend class RcuVector;
+
+		Snapshot(std::atomic<std::uint64_t>& slot, const std::vector<int>* values)
+			: m_slot(slot)
+			, m_values(values)
+		{
+		}
+
+		std::atomic<std::uint64_t>& m_slot;
+		const std::vector<int>* m_values;
+	};
+
+	RcuVector()
+		: RcuVector(std::vector<int> {})
+	{
+	}
+
+	explicit RcuVector(std::vector<int> values)
+		: m_current(new std::vector<int>(std::move(values)))
+	{
+	}
+
+	~RcuVector()
+	{
+		delete m_current.load();
+		for (const Retired& retired : m_retired)
+		{
+			delete retired.values;
+		}
+	}
+
+	RcuVector(const RcuVector&) = delete;
+	RcuVector& operator=(const RcuVector&) = delete;
+
+	/// Wait-free. One snapshot at a time per reader.
+	Snapshot read(Reader& reader)
+	{
+		assert(&reader.m_vector == this);
+		std::atomic<std::uint64_t>& slot =
+			m_reader_epochs[static_cast<std::size_t>(reader.m_slot)].value;
+		assert(slot.load() == 0);
+		// Announce the epoch before loading the pointer. Both are sequentially
+		// consistent, so a writer that doesn't see the announcement has
+		// already published the version this reader will load.
+		slot.store(m_epoch.value.load());
+		return Snapshot(slot, m_current.load());
+	}
+
+	/// Copy the current version, call 'modify(copy)', and publish the result.
+	template <typename Modify>
+	void update(Modify modify)
+	{
+		std::lock_guard lock(m_write_mutex);
+		auto* next = new std::vector<int>(*m_current.load());
+		modify(*next);
+		const std::vector<int>* previous = m_current.exchange(next);
+		// Epochs start at 1 so that 0 can mean "not reading".
+		const std::uint64_t retired_in = m_epoch.value.fetch_add(1);
+		m_retired.push_back({previous, retired_in});
+		reclaim();
+	}
+
+	void push_back(int value)
+	{
+		update([value](std::vector<int>& values) { values.push_back(value); });
+	}
+
+	/// Number of replaced versions not yet deleted because a reader may still
+	/// be using them.
+	std::ptrdiff_t numRetired() const
+	{
+		std::lock_guard lock(m_write_mutex);
+		return std::ssize(m_retired);
+	}
+
+private:
+	struct Retired
+	{
+		const std::vector<int>* values;
+		std::uint64_t epoch;
+	};
+
+	int claimSlot()
+	{
+		for (int slot = 0; slot < MAX_READERS; ++slot)
+		{
+			std::atomic<bool>& in_use = m_slot_in_use[static_cast<std::size_t>(slot)].value;
+			if (bool expected {false}; in_use.compare_exchange_strong(expected, true))
+			{
+				return slot;
+			}
+		}
+		throw std::length_error("RcuVector: more than MAX_READERS readers.");
+	}
+
+	/// Delete every retired version no reader can still see. Called with the
+	/// write mutex held.
+	void reclaim()
+	{
+		std::uint64_t oldest_reading {UINT64_MAX};
+		for (const CacheLinePadded<std::atomic<std::uint64_t>>& slot : m_reader_epochs)
+		{
+			const std::uint64_t epoch = slot.value.load();
+			if (epoch != 0 && epoch < oldest_reading)
+			{
+				oldest_reading = epoch;
+			}
+		}
+
+		std::erase_if(m_retired, [oldest_reading](const Retired& retired) {
+			if (retired.epoch < oldest_reading)
+			{
+				delete retired.values;
+				return true;
+			}
+			return false;
+		});
+	}
+
+private:
+	std::atomic<const std::vector<int>*> m_current;
+	CacheLinePadded<std::atomic<std::uint64_t>> m_epoch {1};
+	std::array<CacheLinePadded<std::atomic<std::uint64_t>>, MAX_READERS> m_reader_epochs {};
+	std::array<CacheLinePadded<std::atomic<bool>>, MAX_READERS> m_slot_in_use {};
+
+	mutable std::mutex m_write_mutex;
+	std::vector<Retired> m_retired;
+};
+
+/// Same as 'sum' in if_init.cpp, for a snapshot. No lock is taken.
+inline long long sum(const RcuVector::Snapshot& snapshot)
+{
+	long long sum = 0;
+
+	if (std::span<const int> values = snapshot.values(); !values.empty())
+	{
+		sum = std::accumulate(values.begin(), values.end(), 0LL, std::plus());
+	}
+
+	return sum;
+}
@@ -0,0 +1,98 @@
+#include "running_sum.h"
+
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <vector>
+
+// Same as in if_init.cpp.
+int sum(std::vector<int>& container, std::mutex& mutex)
+{
+	int sum = 0;
+
+	if (std::lock_guard lock(mutex); !container.empty())
+	{
+		sum = std::accumulate(container.begin(), container.end(), 0, std::plus());
+	}
+
+	return sum;
+}
+
+template <typename Function>
+double milliseconds(Function function)
+{
+	const auto start = std::chrono::steady_clock::now();
+	function();
+	const auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+void sums_follow_updates()
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	RunningSumVector data({1, 2, 3, 4});
+	std::cout << "  total " << data.total() << ", first two " << data.prefixSum(2)
+			  << ", [1, 3) " << data.rangeSum(1, 3) << '\n';
+	data.push_back(10);
+	data.update(0, 5);
+	std::cout << "  After push_back(10) and update(0, 5): total " << data.total()
+			  << ", first two " << data.prefixSum(2) << '\n';
+	data.erase(1);
+	data.pop_back();
+	std::cout << "  After erase(1) and pop_back(): total " << data.total() << ", [1, 3) "
+			  << data.rangeSum(1, 3) << '\n';
+}
+
+void poll_often_update_rarely()
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	constexpr int num_elements {1'000'000};
+	constexpr int num_polls {200};
+	constexpr int polls_per_update {20};
+
+	std::vector<int> data(num_elements, 1);
+	std::mutex mutex;
+	RunningSumVector running(data);
+	std::mt19937 random(1234);
+	std::uniform_int_distribution<int> index_of(0, num_elements - 1);
+
+	long long recomputed {0};
+	const double recompute_ms = milliseconds([&]() {
+		for (int poll = 0; poll < num_polls; ++poll)
+		{
+			if (poll % polls_per_update == 0)
+			{
+				std::lock_guard lock(mutex);
+				data[static_cast<std::size_t>(index_of(random))] += 1;
+			}
+			recomputed = sum(data, mutex);
+		}
+	});
+
+	random.seed(1234);
+	long long maintained {0};
+	const double running_ms = milliseconds([&]() {
+		for (int poll = 0; poll < num_polls; ++poll)
+		{
+			if (poll % polls_per_update == 0)
+			{
+				const std::ptrdiff_t index = index_of(random);
+				running.update(index, running[index] + 1);
+			}
+			maintained = running.total();
+		}
+	});
+
+	std::cout << "  Recomputed on every poll: " << recomputed << " in " << recompute_ms << " ms\n";
+	std::cout << "  Maintained on update:     " << maintained << " in " << running_ms << " ms\n";
+}
+
+int main()
+{
+	sums_follow_updates();
+	poll_often_update_rarely();
+}
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/*
+A thread-safe vector of ints that keeps its sums up to date as it changes.
+
+'sum' in if_init.cpp walks the whole vector on every call. When the sum is
+read far more often than the vector changes that is wasted work, the answer
+only changes by the value that was added, removed, or replaced.
+
+RunningSumVector keeps the total in an atomic that is updated by every write,
+so reading it is one load with no lock. For the sum of a prefix or a range it
+also maintains a Fenwick tree, a.k.a. binary indexed tree, over the elements.
+Node i of the tree, counting from 1, holds the sum of the lowbit(i) elements
+ending at element i, where lowbit(i) is the lowest set bit of i. A prefix sum
+adds up the nodes found by repeatedly clearing the lowest set bit, and an
+update adds the difference to the nodes found by repeatedly adding the lowest
+set bit. Both visit at most log2(n) nodes.
+
+- push_back, pop_back, update: O(log n), O(1), O(log n).
+- total: O(1), lock-free.
+- prefixSum, rangeSum: O(log n), under the lock.
+- erase: O(n), the elements after the erased one shift down and every node
+  covering them changes. The tree is rebuilt in linear time.
+*/
+
+class RunningSumVector
+{
+public:
+	RunningSumVector() = default;
+
+	explicit RunningSumVector(std::vector<int> values)
+		: m_values(std::move(values))
+	{
+		rebuild();
+	}
+
+	std::ptrdiff_t size() const
+	{
+		std::lock_guard lock(m_mutex);
+		return std::ssize(m_values);
+	}
+
+	int operator[](std::ptrdiff_t index) const
+	{
+		std::lock_guard lock(m_mutex);
+		assert(index >= 0 && index < std::ssize(m_values));
+		return m_values[static_cast<std::size_t>(index)];
+	}
+
+	/// Sum of all elements. Never blocks, readable while another thread writes.
+	long long total() const
+	{
+		return m_total.load(std::memory_order_acquire);
+	}
+
+	/// Sum of the first 'count' elements.
+	long long prefixSum(std::ptrdiff_t count) const
+	{
+		std::lock_guard lock(m_mutex);
+		return prefixSumLocked(count);
+	}
+
+	/// Sum of the elements in [first, last).
+	long long rangeSum(std::ptrdiff_t first, std::ptrdiff_t last) const
+	{
+		long long sum {0};
+
+		if (std::lock_guard lock(m_mutex); first < last)
+		{
+			sum = prefixSumLocked(last) - prefixSumLocked(first);
+		}
+
+		return sum;
+	}
+
+	void push_back(int value)
+	{
+		std::lock_guard lock(m_mutex);
+		// The new node i covers the elements (i - lowbit(i), i], the new element
+		// and the ones before it that no other node between them covers.
+		const std::ptrdiff_t i = std::ssize(m_values) + 1;
+		const long long node = value + prefixSumLocked(i - 1) - prefixSumLocked(i - lowbit(i));
+		m_values.push_back(value);
+		m_tree.push_back(node);
+		addToTotal(value);
+	}
+
+	void pop_back()
+	{
+		std::lock_guard lock(m_mutex);
+		assert(!m_values.empty());
+		// The last node is the only one that covers the last element.
+		const int value = m_values.back();
+		m_values.pop_back();
+		m_tree.pop_back();
+		addToTotal(-static_cast<long long>(value));
+	}
+
+	/// Replace the element at 'index' with 'value'.
+	void update(std::ptrdiff_t index, int value)
+	{
+		std::lock_guard lock(m_mutex);
+		assert(index >= 0 && index < std::ssize(m_values));
+		int& element = m_values[static_cast<std::size_t>(index)];
+		const long long delta = static_cast<long long>(value) - element;
+		element = value;
+		for (std::ptrdiff_t i = index + 1; i <= std::ssize(m_tree); i += lowbit(i))
+		{
+			m_tree[static_cast<std::size_t>(i - 1)] += delta;
+		}
+		addToTotal(delta);
+	}
+
+	void erase(std::ptrdiff_t index)
+	{
+		std::lock_guard lock(m_mutex);
+		assert(index >= 0 && index < std::ssize(m_values));
+		m_values.erase(m_values.begin() + index);
+		rebuild();
+	}
+
+private:
+	static std::ptrdiff_t lowbit(std::ptrdiff_t i)
+	{
+		return i & -i;
+	}
+
+	long long prefixSumLocked(std::ptrdiff_t count) const
+	{
+		assert(count >= 0 && count <= std::ssize(m_values));
+		long long sum {0};
+		for (std::ptrdiff_t i = count; i > 0; i -= lowbit(i))
+		{
+			sum += m_tree[static_cast<std::size_t>(i - 1)];
+		}
+		return sum;
+	}
+
+	/// Recompute the tree and the total from 'm_values' in O(n).
+	void rebuild()
+	{
+		m_tree.assign(m_values.begin(), m_values.end());
+		long long total {0};
+		for (std::ptrdiff_t i = 1; i <= std::ssize(m_tree); ++i)
+		{
+			total += m_values[static_cast<std::size_t>(i - 1)];
+			// Every node adds itself to the next node that covers it.
+			const std::ptrdiff_t parent = i + lowbit(i);
+			if (parent <= std::ssize(m_tree))
+			{
+				const long long node = m_tree[static_cast<std::size_t>(i - 1)];
+				m_tree[static_cast<std::size_t>(parent - 1)] += node;
+			}
+		}
+		m_total.store(total, std::memory_order_release);
+	}
+
+	void addToTotal(long long delta)
+	{
+		// Only writers, who hold the mutex, modify the total.
+		m_total.store(m_total.load(std::memory_order_relaxed) + delta, std::memory_order_release);
+	}
+
+private:
+	mutable std::mutex m_mutex;
+	std::vector<int> m_values;
+	/// m_tree[i - 1] is node i.
+	std::vector<long long> m_tree;
+	std::atomic<long long> m_total {0};
+};
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/*
+Array-of-structs image, the layout used by 'Pixel' and 'Image' in
+signed_unsigned/from_compiler_explorer.cpp but with the size decided at
+runtime instead of a fixed 65535 pixel array.
+
+Sizes and coordinates are signed, since the traversal code steps through
+rows with negative strides.
+*/
+
+struct Pixel
+{
+	float red;
+	float green;
+	float blue;
+};
+
+enum class Channel
+{
+	Red,
+	Green,
+	Blue
+};
+
+constexpr int NUM_CHANNELS {3};
+
+/// Pointer-to-member for the given channel, for code that wants to work on a
+/// single channel of a Pixel without a switch per pixel.
+constexpr float Pixel::*member(Channel channel)
+{
+	switch (channel)
+	{
+		case Channel::Red:
+			return &Pixel::red;
+		case Channel::Green:
+			return &Pixel::green;
+		case Channel::Blue:
+			return &Pixel::blue;
+	}
+	return &Pixel::red;
+}
+
+class Image
+{
+public:
+	Image(std::ptrdiff_t width, std::ptrdiff_t height)
+		: m_width(width)
+		, m_height(height)
+		, m_pixels(static_cast<std::size_t>(width * height), Pixel {0.0f, 0.0f, 0.0f})
+	{
+	}
+
+	std::ptrdiff_t width() const
+	{
+		return m_width;
+	}
+
+	std::ptrdiff_t height() const
+	{
+		return m_height;
+	}
+
+	/// Number of pixels from the start of one row to the start of the next.
+	std::ptrdiff_t stride() const
+	{
+		return m_width;
+	}
+
+	Pixel* data()
+	{
+		return m_pixels.data();
+	}
+
+	const Pixel* data() const
+	{
+		return m_pixels.data();
+	}
+
+	Pixel* row(std::ptrdiff_t y)
+	{
+		return data() + y * stride();
+	}
+
+	const Pixel* row(std::ptrdiff_t y) const
+	{
+		return data() + y * stride();
+	}
+
+	Pixel& operator()(std::ptrdiff_t x, std::ptrdiff_t y)
+	{
+		return row(y)[x];
+	}
+
+	const Pixel& operator()(std::ptrdiff_t x, std::ptrdiff_t y) const
+	{
+		return row(y)[x];
+	}
+
+private:
+	std::ptrdiff_t m_width;
+	std::ptrdiff_t m_height;
+	std::vector<Pixel> m_pixels;
+};
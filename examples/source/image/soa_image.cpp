@@ -0,0 +1,133 @@
+#include "image.h"
+#include "soa_image.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+volatile float sink {0.0f};
+
+Image makeImage(std::ptrdiff_t width, std::ptrdiff_t height)
+{
+	Image image(width, height);
+	for (std::ptrdiff_t y = 0; y < height; ++y)
+	{
+		for (std::ptrdiff_t x = 0; x < width; ++x)
+		{
+			image(x, y) = {float(x % 256), float(y % 256), float((x + y) % 256)};
+		}
+	}
+	return image;
+}
+
+// Works with any channel view, AoS or SoA.
+template <typename ChannelView>
+__attribute((noinline)) float sumChannel(const ChannelView& view)
+{
+	float sum {0.0f};
+	for (std::ptrdiff_t y = 0; y < view.height(); ++y)
+	{
+		for (std::ptrdiff_t x = 0; x < view.width(); ++x)
+		{
+			sum += view(x, y);
+		}
+	}
+	return sum;
+}
+
+// Only for SoA, contiguous rows that the compiler can vectorize.
+__attribute((noinline)) void scaleChannel(SoAChannelView<float> view, float factor)
+{
+	for (std::ptrdiff_t y = 0; y < view.height(); ++y)
+	{
+		float* __restrict row = view.row(y);
+		for (std::ptrdiff_t x = 0; x < view.width(); ++x)
+		{
+			row[x] *= factor;
+		}
+	}
+}
+
+__attribute((noinline)) void scaleChannel(AoSChannelView<Pixel> view, float factor)
+{
+	for (std::ptrdiff_t y = 0; y < view.height(); ++y)
+	{
+		for (std::ptrdiff_t x = 0; x < view.width(); ++x)
+		{
+			view(x, y) *= factor;
+		}
+	}
+}
+
+template <typename Function>
+double milliseconds(Function function)
+{
+	const auto start = std::chrono::steady_clock::now();
+	function();
+	const auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+void layout()
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	Image aos(100, 3);
+	SoAImage soa(100, 3);
+	std::cout << "  sizeof(Pixel): " << sizeof(Pixel) << '\n';
+	std::cout << "  AoS bytes:     " << aos.width() * aos.height() * std::ptrdiff_t(sizeof(Pixel))
+			  << '\n';
+	std::cout << "  SoA bytes:     " << soa.sizeInBytes() << " (stride " << soa.stride()
+			  << " floats for width " << soa.width() << ")\n";
+	std::cout << "  Red plane aligned: "
+			  << (reinterpret_cast<std::uintptr_t>(soa.plane(Channel::Red)) % SoAImage::ALIGNMENT == 0)
+			  << '\n';
+}
+
+void views()
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	Image aos = makeImage(7, 5);
+	SoAImage soa = toSoA(aos);
+
+	// The same generic algorithm over both layouts.
+	std::cout << "  AoS green sum: " << sumChannel(channelView(aos, Channel::Green)) << '\n';
+	std::cout << "  SoA green sum: " << sumChannel(channelView(soa, Channel::Green)) << '\n';
+
+	// AoS-style code writing to an SoA image.
+	SoAPixelView pixels = pixelView(soa);
+	pixels(3, 2) = Pixel {1.0f, 2.0f, 3.0f};
+	Pixel pixel = pixels(3, 2);
+	std::cout << "  Pixel (3, 2): " << pixel.red << ' ' << pixel.green << ' ' << pixel.blue << '\n';
+	std::cout << "  Blue plane at (3, 2): " << soa(Channel::Blue, 3, 2) << '\n';
+
+	Image round_trip = toAoS(soa);
+	std::cout << "  Round trip (3, 2) blue: " << round_trip(3, 2).blue << '\n';
+}
+
+void single_channel_pass()
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	Image aos = makeImage(4000, 3000);
+	SoAImage soa = toSoA(aos);
+
+	const double aos_ms =
+		milliseconds([&]() { scaleChannel(channelView(aos, Channel::Red), 0.5f); });
+	const double soa_ms =
+		milliseconds([&]() { scaleChannel(channelView(soa, Channel::Red), 0.5f); });
+
+	sink = sumChannel(channelView(aos, Channel::Red)) - sumChannel(channelView(soa, Channel::Red));
+	std::cout << "  Difference between layouts: " << sink << '\n';
+	std::cout << "  AoS scale red: " << aos_ms << " ms\n";
+	std::cout << "  SoA scale red: " << soa_ms << " ms\n";
+}
+
+int main()
+{
+	layout();
+	views();
+	single_channel_pass();
+}
@@ -0,0 +1,376 @@
+#pragma once
+
+#include "image.h"
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/*
+Struct-of-arrays image, one plane of floats per channel.
+
+A pass that only reads the red channel of an AoS 'Image' still pulls green and
+blue into the cache, since they share cache lines with red. Here the red
+channel is one contiguous plane and such a pass touches a third of the bytes.
+Contiguous floats are also what SIMD loads want.
+
+Every plane starts on a 64 byte boundary and every row is padded to a multiple
+of 64 bytes, so every row starts on a cache line and on an AVX-512 register
+boundary. The padding is never part of the image, 'width' is the number of
+visible pixels and 'stride' the number of floats between rows.
+*/
+
+class SoAImage
+{
+public:
+	static constexpr std::ptrdiff_t ALIGNMENT {64};
+	static constexpr std::ptrdiff_t FLOATS_PER_ALIGNMENT {
+		ALIGNMENT / std::ptrdiff_t(sizeof(float))};
+
+	SoAImage(std::ptrdiff_t width, std::ptrdiff_t height)
+		: m_width(width)
+		, m_height(height)
+		, m_stride(paddedStride(width))
+		, m_data(allocate(planeSize(m_stride, height) * NUM_CHANNELS))
+	{
+		std::memset(m_data.get(), 0, sizeInBytes());
+	}
+
+	SoAImage(const SoAImage& other)
+		: m_width(other.m_width)
+		, m_height(other.m_height)
+		, m_stride(other.m_stride)
+		, m_data(allocate(planeSize(m_stride, m_height) * NUM_CHANNELS))
+	{
+		// A moved-from image has no data, and memcpy from nullptr is undefined
+		// even for zero bytes.
+		if (other.m_data != nullptr)
+		{
+			std::memcpy(m_data.get(), other.m_data.get(), sizeInBytes());
+		}
+	}
+
+	/// Leaves 'other' as a 0 x 0 image without data.
+	SoAImage(SoAImage&& other) noexcept
+		: m_width(std::exchange(other.m_width, 0))
+		, m_height(std::exchange(other.m_height, 0))
+		, m_stride(std::exchange(other.m_stride, 0))
+		, m_data(std::move(other.m_data))
+	{
+	}
+
+	SoAImage& operator=(const SoAImage& other)
+	{
+		SoAImage copy(other);
+		return *this = std::move(copy);
+	}
+
+	SoAImage& operator=(SoAImage&& other) noexcept
+	{
+		m_width = std::exchange(other.m_width, 0);
+		m_height = std::exchange(other.m_height, 0);
+		m_stride = std::exchange(other.m_stride, 0);
+		m_data = std::move(other.m_data);
+		return *this;
+	}
+
+	std::ptrdiff_t width() const
+	{
+		return m_width;
+	}
+
+	std::ptrdiff_t height() const
+	{
+		return m_height;
+	}
+
+	/// Number of floats from the start of one row to the start of the next.
+	/// Always a multiple of FLOATS_PER_ALIGNMENT and at least 'width'.
+	std::ptrdiff_t stride() const
+	{
+		return m_stride;
+	}
+
+	std::size_t sizeInBytes() const
+	{
+		return static_cast<std::size_t>(planeSize(m_stride, m_height) * NUM_CHANNELS) *
+			sizeof(float);
+	}
+
+	float* plane(Channel channel)
+	{
+		return m_data.get() + static_cast<std::ptrdiff_t>(channel) * planeSize(m_stride, m_height);
+	}
+
+	const float* plane(Channel channel) const
+	{
+		return m_data.get() + static_cast<std::ptrdiff_t>(channel) * planeSize(m_stride, m_height);
+	}
+
+	float* row(Channel channel, std::ptrdiff_t y)
+	{
+		return plane(channel) + y * m_stride;
+	}
+
+	const float* row(Channel channel, std::ptrdiff_t y) const
+	{
+		return plane(channel) + y * m_stride;
+	}
+
+	float& operator()(Channel channel, std::ptrdiff_t x, std::ptrdiff_t y)
+	{
+		return row(channel, y)[x];
+	}
+
+	float operator()(Channel channel, std::ptrdiff_t x, std::ptrdiff_t y) const
+	{
+		return row(channel, y)[x];
+	}
+
+private:
+	struct Free
+	{
+		void operator()(float* data) const
+		{
+			std::free(data);
+		}
+	};
+
+	static std::ptrdiff_t paddedStride(std::ptrdiff_t width)
+	{
+		return (width + FLOATS_PER_ALIGNMENT - 1) / FLOATS_PER_ALIGNMENT * FLOATS_PER_ALIGNMENT;
+	}
+
+	static std::ptrdiff_t planeSize(std::ptrdiff_t stride, std::ptrdiff_t height)
+	{
+		return stride * height;
+	}
+
+	static std::unique_ptr<float[], Free> allocate(std::ptrdiff_t num_floats)
+	{
+		// aligned_alloc requires the size to be a multiple of the alignment,
+		// which the row padding guarantees. It may return nullptr for size 0.
+		const std::size_t bytes = static_cast<std::size_t>(num_floats) * sizeof(float);
+		void* memory = std::aligned_alloc(ALIGNMENT, bytes == 0 ? ALIGNMENT : bytes);
+		if (memory == nullptr)
+		{
+			throw std::bad_alloc();
+		}
+		return std::unique_ptr<float[], Free>(static_cast<float*>(memory));
+	}
+
+private:
+	std::ptrdiff_t m_width;
+	std::ptrdiff_t m_height;
+	std::ptrdiff_t m_stride;
+	std::unique_ptr<float[], Free> m_data;
+};
+
+/*
+Views. Neither owns or copies any pixel data.
+*/
+
+/// One channel of an SoAImage. Rows are contiguous.
+template <typename Float>
+class SoAChannelView
+{
+public:
+	SoAChannelView(Float* data, std::ptrdiff_t width, std::ptrdiff_t height, std::ptrdiff_t stride)
+		: m_data(data)
+		, m_width(width)
+		, m_height(height)
+		, m_stride(stride)
+	{
+	}
+
+	std::ptrdiff_t width() const
+	{
+		return m_width;
+	}
+
+	std::ptrdiff_t height() const
+	{
+		return m_height;
+	}
+
+	Float* row(std::ptrdiff_t y) const
+	{
+		return m_data + y * m_stride;
+	}
+
+	Float& operator()(std::ptrdiff_t x, std::ptrdiff_t y) const
+	{
+		return row(y)[x];
+	}
+
+private:
+	Float* m_data;
+	std::ptrdiff_t m_width;
+	std::ptrdiff_t m_height;
+	std::ptrdiff_t m_stride;
+};
+
+/// One channel of an AoS Image. Each access goes through a pointer-to-member,
+/// which is a strided load once the compiler is done with it. This gives
+/// SoA-style channel access to an existing AoS image without a conversion,
+/// but still reads every byte of every pixel from memory.
+template <typename PixelT>
+class AoSChannelView
+{
+public:
+	using Float = std::conditional_t<std::is_const_v<PixelT>, const float, float>;
+
+	AoSChannelView(
+		PixelT* pixels, std::ptrdiff_t width, std::ptrdiff_t height, std::ptrdiff_t stride,
+		Channel channel)
+		: m_pixels(pixels)
+		, m_width(width)
+		, m_height(height)
+		, m_stride(stride)
+		, m_member(member(channel))
+	{
+	}
+
+	std::ptrdiff_t width() const
+	{
+		return m_width;
+	}
+
+	std::ptrdiff_t height() const
+	{
+		return m_height;
+	}
+
+	Float& operator()(std::ptrdiff_t x, std::ptrdiff_t y) const
+	{
+		return m_pixels[y * m_stride + x].*m_member;
+	}
+
+private:
+	PixelT* m_pixels;
+	std::ptrdiff_t m_width;
+	std::ptrdiff_t m_height;
+	std::ptrdiff_t m_stride;
+	float Pixel::*m_member;
+};
+
+/// A Pixel-like proxy to the three channels of one pixel in an SoAImage. Lets
+/// code written against the AoS layout read and write an SoAImage.
+struct PixelRef
+{
+	float& red;
+	float& green;
+	float& blue;
+
+	operator Pixel() const
+	{
+		return {red, green, blue};
+	}
+
+	const PixelRef& operator=(const Pixel& pixel) const
+	{
+		red = pixel.red;
+		green = pixel.green;
+		blue = pixel.blue;
+		return *this;
+	}
+};
+
+/// All channels of an SoAImage accessed as pixels.
+class SoAPixelView
+{
+public:
+	explicit SoAPixelView(SoAImage& image)
+		: m_image(&image)
+	{
+	}
+
+	std::ptrdiff_t width() const
+	{
+		return m_image->width();
+	}
+
+	std::ptrdiff_t height() const
+	{
+		return m_image->height();
+	}
+
+	PixelRef operator()(std::ptrdiff_t x, std::ptrdiff_t y) const
+	{
+		return {
+			(*m_image)(Channel::Red, x, y), (*m_image)(Channel::Green, x, y),
+			(*m_image)(Channel::Blue, x, y)};
+	}
+
+private:
+	SoAImage* m_image;
+};
+
+inline SoAChannelView<float> channelView(SoAImage& image, Channel channel)
+{
+	return {image.plane(channel), image.width(), image.height(), image.stride()};
+}
+
+inline SoAChannelView<const float> channelView(const SoAImage& image, Channel channel)
+{
+	return {image.plane(channel), image.width(), image.height(), image.stride()};
+}
+
+inline AoSChannelView<Pixel> channelView(Image& image, Channel channel)
+{
+	return {image.data(), image.width(), image.height(), image.stride(), channel};
+}
+
+inline AoSChannelView<const Pixel> channelView(const Image& image, Channel channel)
+{
+	return {image.data(), image.width(), image.height(), image.stride(), channel};
+}
+
+inline SoAPixelView pixelView(SoAImage& image)
+{
+	return SoAPixelView(image);
+}
+
+/*
+Conversions. These do copy, one pass over the image per conversion.
+*/
+
+inline SoAImage toSoA(const Image& image)
+{
+	SoAImage result(image.width(), image.height());
+	for (std::ptrdiff_t y = 0; y < image.height(); ++y)
+	{
+		const Pixel* source = image.row(y);
+		float* __restrict red = result.row(Channel::Red, y);
+		float* __restrict green = result.row(Channel::Green, y);
+		float* __restrict blue = result.row(Channel::Blue, y);
+		for (std::ptrdiff_t x = 0; x < image.width(); ++x)
+		{
+			red[x] = source[x].red;
+			green[x] = source[x].green;
+			blue[x] = source[x].blue;
+		}
+	}
+	return result;
+}
+
+inline Image toAoS(const SoAImage& image)
+{
+	Image result(image.width(), image.height());
+	for (std::ptrdiff_t y = 0; y < image.height(); ++y)
+	{
+		const float* red = image.row(Channel::Red, y);
+		const float* green = image.row(Channel::Green, y);
+		const float* blue = image.row(Channel::Blue, y);
+		Pixel* destination = result.row(y);
+		for (std::ptrdiff_t x = 0; x < image.width(); ++x)
+		{
+			destination[x] = {red[x], green[x], blue[x]};
+		}
+	}
+	return result;
+}
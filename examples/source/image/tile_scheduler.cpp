@@ -0,0 +1,69 @@
+#include "image.h"
+#include "tile_scheduler.h"
+
+#include <cmath>
+#include <cstddef>
+#include <iomanip>
+#include <iostream>
+
+Image makeImage(std::ptrdiff_t width, std::ptrdiff_t height)
+{
+	Image image(width, height);
+	for (std::ptrdiff_t y = 0; y < height; ++y)
+	{
+		for (std::ptrdiff_t x = 0; x < width; ++x)
+		{
+			image(x, y) = {float(x % 256) / 255.0f, float(y % 256) / 255.0f, 0.5f};
+		}
+	}
+	return image;
+}
+
+void print(const char* label, const ScheduleReport& report)
+{
+	std::cout << "  " << label << ": " << std::fixed << std::setprecision(2) << report.wall_ms
+			  << " ms wall\n";
+	for (std::size_t worker = 0; worker < report.workers.size(); ++worker)
+	{
+		const WorkerTimings& timings = report.workers[worker];
+		std::cout << "    worker " << worker << ": " << std::setw(4) << timings.num_tiles
+				  << " tiles, " << std::setw(3) << timings.num_steals << " stolen, " << std::setw(8)
+				  << timings.busy_ms << " ms busy\n";
+	}
+}
+
+// A per-pixel kernel whose cost grows towards the bottom of the image, so that
+// a static split gives some workers much more work than others.
+void adjustGamma(Grid<Pixel> tile, Tile region)
+{
+	for (std::ptrdiff_t y = 0; y < tile.height; ++y)
+	{
+		const int iterations = 1 + int(region.y + y) / 128;
+		Pixel* row = tile.row(y);
+		for (std::ptrdiff_t x = 0; x < tile.width; ++x)
+		{
+			for (int i = 0; i < iterations; ++i)
+			{
+				row[x].red = std::pow(row[x].red, 1.01f);
+				row[x].green = std::pow(row[x].green, 1.01f);
+			}
+		}
+	}
+}
+
+int main()
+{
+	WorkStealingPool pool(4);
+	std::cout << "Workers: " << pool.numThreads() << '\n';
+
+	Image image = makeImage(1024, 1024);
+	const Grid<Pixel> grid = gridOf(image);
+
+	print("Row bands of 64", parallelForEachBand(pool, grid, 64, adjustGamma));
+	print("Tiles 128x128", parallelForEachTile(pool, grid, TileShape {128, 128}, adjustGamma));
+
+	// Same as work_backwards, with a negative stride. The kernel sees rows
+	// counted from the bottom of the image.
+	const Grid<Pixel> bottom_up = gridOf(image, RowOrder::BottomUp);
+	print("Bottom-up bands", parallelForEachBand(pool, bottom_up, 64, adjustGamma));
+}
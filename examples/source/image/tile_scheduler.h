@@ -0,0 +1,99 @@
+#pragma once
+
+#include "cache_line.h"
+#include "tiled_traversal.h"
+#include "work_stealing_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+/*
+Runs a per-tile kernel on every tile of a grid, in parallel.
+
+The grid is split either into row bands, full-width strips of rows like the
+rows handed to 'work' in signed_unsigned/from_compiler_explorer.cpp, or into
+2D tiles. Bands are best for row-wise kernels, tiles for kernels that also
+walk down columns. Every band or tile becomes one task on a work-stealing
+pool, so a worker that finishes its share early takes tiles from a worker
+that is still busy, e.g. because its part of the image is more expensive to
+process.
+*/
+
+struct WorkerTimings
+{
+	std::ptrdiff_t num_tiles {0};
+	std::ptrdiff_t num_steals {0};
+	double busy_ms {0.0};
+};
+
+struct ScheduleReport
+{
+	double wall_ms {0.0};
+	std::vector<WorkerTimings> workers;
+};
+
+/// Call 'kernel(Grid<T> tile_grid, Tile tile)' for every tile, in parallel.
+/// The kernel must only write inside its own tile.
+template <typename T, typename Kernel>
+ScheduleReport parallelForEachTile(
+	WorkStealingPool& pool, const Grid<T>& grid, TileShape shape, Kernel kernel)
+{
+	using Clock = std::chrono::steady_clock;
+
+	// Tiles in row-major order. Each worker gets a contiguous range of tiles
+	// to start with, i.e. a few neighbouring rows of tiles.
+	std::vector<Tile> tiles;
+	forEachTile(grid, shape, TileOrder::RowMajor, [&tiles](Grid<T>, Tile tile) {
+		tiles.push_back(tile);
+	});
+
+	std::vector<std::ptrdiff_t> steals_before(static_cast<std::size_t>(pool.numThreads()));
+	for (int worker = 0; worker < pool.numThreads(); ++worker)
+	{
+		steals_before[static_cast<std::size_t>(worker)] = pool.numSteals(worker);
+	}
+
+	// Written by the worker that ran the tile, padded so that workers don't
+	// share cache lines.
+	std::vector<CacheLinePadded<WorkerTimings>> timings(
+		static_cast<std::size_t>(pool.numThreads()));
+
+	const Clock::time_point start = Clock::now();
+	pool.parallelFor(std::ssize(tiles), [&](std::ptrdiff_t index) {
+		const Tile tile = tiles[static_cast<std::size_t>(index)];
+		const Clock::time_point tile_start = Clock::now();
+		kernel(subGrid(grid, tile), tile);
+		const Clock::time_point tile_stop = Clock::now();
+
+		WorkerTimings& worker =
+			timings[static_cast<std::size_t>(WorkStealingPool::currentWorker())].value;
+		++worker.num_tiles;
+		worker.busy_ms +=
+			std::chrono::duration<double, std::milli>(tile_stop - tile_start).count();
+	});
+	const Clock::time_point stop = Clock::now();
+
+	ScheduleReport report;
+	report.wall_ms = std::chrono::duration<double, std::milli>(stop - start).count();
+	for (int worker = 0; worker < pool.numThreads(); ++worker)
+	{
+		WorkerTimings worker_timings = timings[static_cast<std::size_t>(worker)].value;
+		worker_timings.num_steals =
+			pool.numSteals(worker) - steals_before[static_cast<std::size_t>(worker)];
+		report.workers.push_back(worker_timings);
+	}
+	return report;
+}
+
+/// Call 'kernel(Grid<T> band_grid, Tile band)' for every band of 'band_height'
+/// full-width rows, in parallel.
+template <typename T, typename Kernel>
+ScheduleReport parallelForEachBand(
+	WorkStealingPool& pool, const Grid<T>& grid, std::ptrdiff_t band_height, Kernel kernel)
+{
+	// An empty grid has no bands, but the tile shape must still be valid.
+	const TileShape shape {std::max(grid.width, std::ptrdiff_t {1}), band_height};
+	return parallelForEachTile(pool, grid, shape, kernel);
+}
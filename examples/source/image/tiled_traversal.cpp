@@ -0,0 +1,138 @@
+#include "image.h"
+#include "tiled_traversal.h"
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <utility>
+
+template <typename Function>
+double milliseconds(Function function)
+{
+	const auto start = std::chrono::steady_clock::now();
+	function();
+	const auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+Image makeImage(std::ptrdiff_t width, std::ptrdiff_t height)
+{
+	Image image(width, height);
+	for (std::ptrdiff_t y = 0; y < height; ++y)
+	{
+		for (std::ptrdiff_t x = 0; x < width; ++x)
+		{
+			image(x, y) = {float(x), float(y), float(x + y)};
+		}
+	}
+	return image;
+}
+
+// Same as 'work_forwards' and 'work_backwards', report the first pixel of
+// every row.
+void forwards_and_backwards()
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	Image image = makeImage(4, 3);
+	for (RowOrder order : {RowOrder::TopDown, RowOrder::BottomUp})
+	{
+		Grid<const Pixel> grid = gridOf(std::as_const(image), order);
+		std::cout << "  stride " << grid.row_stride << ", rows starting with y =";
+		for (std::ptrdiff_t y = 0; y < grid.height; ++y)
+		{
+			std::cout << ' ' << grid.row(y)[0].green;
+		}
+		std::cout << '\n';
+	}
+}
+
+void tile_orders()
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	Image image(10, 7);
+	const Grid<Pixel> grid = gridOf(image);
+	const TileShape shape {4, 4};
+	for (TileOrder order : {TileOrder::RowMajor, TileOrder::ColumnMajor, TileOrder::Morton})
+	{
+		std::cout << "  ";
+		forEachTile(grid, shape, order, [](Grid<Pixel>, Tile tile) {
+			std::cout << '(' << tile.x << ',' << tile.y << ' ' << tile.width << 'x' << tile.height
+					  << ") ";
+		});
+		std::cout << '\n';
+	}
+}
+
+// Column-major access. Each pixel read touches a new cache line.
+__attribute((noinline)) void transposeNaive(const Image& source, Image& destination)
+{
+	for (std::ptrdiff_t x = 0; x < source.width(); ++x)
+	{
+		for (std::ptrdiff_t y = 0; y < source.height(); ++y)
+		{
+			destination(y, x) = source(x, y);
+		}
+	}
+}
+
+__attribute((noinline)) void transposeTiled(
+	const Image& source, Image& destination, TileShape shape, TileOrder order)
+{
+	forEachTile(gridOf(source), shape, order, [&](Grid<const Pixel> tile_grid, Tile tile) {
+		for (std::ptrdiff_t x = 0; x < tile_grid.width; ++x)
+		{
+			for (std::ptrdiff_t y = 0; y < tile_grid.height; ++y)
+			{
+				destination(tile.y + y, tile.x + x) = tile_grid(x, y);
+			}
+		}
+	});
+}
+
+bool equal(const Image& lhs, const Image& rhs)
+{
+	for (std::ptrdiff_t y = 0; y < lhs.height(); ++y)
+	{
+		for (std::ptrdiff_t x = 0; x < lhs.width(); ++x)
+		{
+			if (lhs(x, y).red != rhs(x, y).red || lhs(x, y).green != rhs(x, y).green ||
+				lhs(x, y).blue != rhs(x, y).blue)
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+void transpose()
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	const Image source = makeImage(4096, 3072);
+	Image expected(source.height(), source.width());
+	Image result(source.height(), source.width());
+
+	const TileShape shape = tileShapeForCache(sizeof(Pixel));
+	std::cout << "  Tile: " << shape.width << 'x' << shape.height << '\n';
+
+	std::cout << "  naive:       " << milliseconds([&]() { transposeNaive(source, expected); })
+			  << " ms\n";
+
+	for (TileOrder order : {TileOrder::RowMajor, TileOrder::ColumnMajor, TileOrder::Morton})
+	{
+		const char* names[] {"row-major:  ", "col-major:  ", "Morton:     "};
+		const double ms = milliseconds([&]() { transposeTiled(source, result, shape, order); });
+		std::cout << "  " << names[static_cast<int>(order)] << ' ' << ms << " ms"
+				  << (equal(expected, result) ? "" : " WRONG RESULT") << '\n';
+	}
+}
+
+int main()
+{
+	forwards_and_backwards();
+	tile_orders();
+	transpose();
+}
@@ -0,0 +1,199 @@
+#pragma once
+
+#include "image.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+/*
+Tiled traversal of 2D data.
+
+'work' in signed_unsigned/from_compiler_explorer.cpp walks an image one row at
+a time, forwards or backwards. That is fine for row-wise work, but an algorithm
+that walks down a column touches one cache line per pixel, and by the time it
+gets to the next column the first cache lines have been evicted. Splitting the
+image into tiles small enough to stay in the L1 cache, and running the
+algorithm to completion on one tile before moving to the next, means every
+cache line is loaded once.
+
+Tiles can be visited row by row, column by column, or in Morton / Z-order. In
+Morton order consecutive tiles are neighbours in both directions, which helps
+algorithms that read from neighbouring tiles, e.g. convolution kernels.
+*/
+
+/// A rectangle of elements with a signed row stride. With a negative stride
+/// 'origin' points to the last row in memory and row 1 is the row before it,
+/// which is how 'work_backwards' walks an image bottom up.
+template <typename T>
+struct Grid
+{
+	T* origin;
+	std::ptrdiff_t width;
+	std::ptrdiff_t height;
+	std::ptrdiff_t row_stride;
+
+	T* row(std::ptrdiff_t y) const
+	{
+		return origin + y * row_stride;
+	}
+
+	T& operator()(std::ptrdiff_t x, std::ptrdiff_t y) const
+	{
+		return row(y)[x];
+	}
+};
+
+/// A region of a grid, in grid coordinates.
+struct Tile
+{
+	std::ptrdiff_t x;
+	std::ptrdiff_t y;
+	std::ptrdiff_t width;
+	std::ptrdiff_t height;
+};
+
+enum class RowOrder
+{
+	TopDown,
+	BottomUp
+};
+
+/// The whole image as a grid. With BottomUp the stride is negative. All
+/// arithmetic is signed so there is no 'size_t(-width)' wrap-around like in
+/// work_backwards.
+template <typename ImageT>
+auto gridOf(ImageT& image, RowOrder order = RowOrder::TopDown)
+{
+	using PixelT = std::remove_pointer_t<decltype(image.data())>;
+	if (order == RowOrder::TopDown || image.height() == 0)
+	{
+		return Grid<PixelT> {image.data(), image.width(), image.height(), image.stride()};
+	}
+	return Grid<PixelT> {
+		image.data() + (image.height() - 1) * image.stride(), image.width(), image.height(),
+		-image.stride()};
+}
+
+/// The part of 'grid' covered by 'tile', clamped to the grid so that a partial
+/// tile at the right or bottom edge never reaches outside the grid.
+template <typename T>
+Grid<T> subGrid(const Grid<T>& grid, Tile tile)
+{
+	assert(tile.x >= 0 && tile.y >= 0);
+	const std::ptrdiff_t width =
+		std::max<std::ptrdiff_t>(0, std::min(tile.width, grid.width - tile.x));
+	const std::ptrdiff_t height =
+		std::max<std::ptrdiff_t>(0, std::min(tile.height, grid.height - tile.y));
+	return {grid.row(tile.y) + tile.x, width, height, grid.row_stride};
+}
+
+struct TileShape
+{
+	std::ptrdiff_t width;
+	std::ptrdiff_t height;
+};
+
+/// A square tile that fits in 'cache_bytes' with room to spare for whatever
+/// else the algorithm is touching, e.g. the output of a transpose. The side is
+/// rounded down to a multiple of 'cache_line_bytes / element_size' so that tile
+/// rows start and end on cache line boundaries when the grid rows do.
+inline TileShape tileShapeForCache(
+	std::ptrdiff_t element_size, std::ptrdiff_t cache_bytes = 32 * 1024,
+	std::ptrdiff_t cache_line_bytes = 64)
+{
+	const std::ptrdiff_t budget = cache_bytes / 2;
+	auto side = static_cast<std::ptrdiff_t>(std::sqrt(double(budget / element_size)));
+	const std::ptrdiff_t granularity =
+		std::max<std::ptrdiff_t>(1, cache_line_bytes / element_size);
+	side = std::max(granularity, side / granularity * granularity);
+	return {side, side};
+}
+
+enum class TileOrder
+{
+	RowMajor,
+	ColumnMajor,
+	Morton
+};
+
+namespace detail
+{
+	/// Every other bit of 'code', starting with bit 0, compacted into the low
+	/// 32 bits. Decodes one coordinate of a Morton code.
+	inline std::uint32_t compactBits(std::uint64_t code)
+	{
+		code &= 0x5555555555555555;
+		code = (code | (code >> 1)) & 0x3333333333333333;
+		code = (code | (code >> 2)) & 0x0F0F0F0F0F0F0F0F;
+		code = (code | (code >> 4)) & 0x00FF00FF00FF00FF;
+		code = (code | (code >> 8)) & 0x0000FFFF0000FFFF;
+		code = (code | (code >> 16)) & 0x00000000FFFFFFFF;
+		return static_cast<std::uint32_t>(code);
+	}
+}
+
+/// Call 'callback(Grid<T> tile_grid, Tile tile)' once for every tile of the
+/// grid. Tiles at the right and bottom edges may be smaller than 'shape'.
+template <typename T, typename Callback>
+void forEachTile(const Grid<T>& grid, TileShape shape, TileOrder order, Callback callback)
+{
+	assert(shape.width > 0 && shape.height > 0);
+	const std::ptrdiff_t num_tiles_x = (grid.width + shape.width - 1) / shape.width;
+	const std::ptrdiff_t num_tiles_y = (grid.height + shape.height - 1) / shape.height;
+
+	auto visit = [&](std::ptrdiff_t tile_x, std::ptrdiff_t tile_y) {
+		const Tile tile {tile_x * shape.width, tile_y * shape.height, shape.width, shape.height};
+		const Grid<T> tile_grid = subGrid(grid, tile);
+		callback(tile_grid, Tile {tile.x, tile.y, tile_grid.width, tile_grid.height});
+	};
+
+	switch (order)
+	{
+		case TileOrder::RowMajor:
+			for (std::ptrdiff_t tile_y = 0; tile_y < num_tiles_y; ++tile_y)
+			{
+				for (std::ptrdiff_t tile_x = 0; tile_x < num_tiles_x; ++tile_x)
+				{
+					visit(tile_x, tile_y);
+				}
+			}
+			break;
+		case TileOrder::ColumnMajor:
+			for (std::ptrdiff_t tile_x = 0; tile_x < num_tiles_x; ++tile_x)
+			{
+				for (std::ptrdiff_t tile_y = 0; tile_y < num_tiles_y; ++tile_y)
+				{
+					visit(tile_x, tile_y);
+				}
+			}
+			break;
+		case TileOrder::Morton:
+		{
+			// Walk the Morton codes of the smallest power-of-two square that
+			// covers all tiles and skip the codes that fall outside the grid. For
+			// very elongated grids most codes are skipped, but a skip is only a
+			// few bit operations and a compare, cheap compared to a tile of work.
+			std::ptrdiff_t side {1};
+			while (side < num_tiles_x || side < num_tiles_y)
+			{
+				side *= 2;
+			}
+			const auto num_codes =
+				static_cast<std::uint64_t>(side) * static_cast<std::uint64_t>(side);
+			for (std::uint64_t code = 0; code < num_codes; ++code)
+			{
+				const std::ptrdiff_t tile_x = detail::compactBits(code);
+				const std::ptrdiff_t tile_y = detail::compactBits(code >> 1);
+				if (tile_x < num_tiles_x && tile_y < num_tiles_y)
+				{
+					visit(tile_x, tile_y);
+				}
+			}
+			break;
+		}
+	}
+}
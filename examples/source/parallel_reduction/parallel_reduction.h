@@ -0,0 +1,135 @@
+#pragma once
+
+#include "cache_line.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+/*
+Parallel reduction over an inclusive integer range [first, last].
+
+The range is split into a fixed number of chunks, independent of the number of
+threads, and every chunk is reduced by a user-provided kernel on the thread
+pool. Each chunk writes its result to its own cache line so that chunks
+finishing at the same time on different cores don't invalidate each other's
+cache lines, i.e. no false sharing. The chunk results are then combined on the
+calling thread in chunk order, so the result does not depend on how many
+threads there are or which thread ran which chunk.
+*/
+
+namespace parallel_reduction
+{
+	/// A value together with a sticky flag telling if any operation that
+	/// produced it overflowed.
+	template <typename T>
+	struct Checked
+	{
+		T value {};
+		bool overflow {false};
+	};
+
+	template <typename T>
+	Checked<T> checkedAdd(Checked<T> lhs, Checked<T> rhs)
+	{
+		Checked<T> result;
+		result.overflow = __builtin_add_overflow(lhs.value, rhs.value, &result.value);
+		result.overflow |= lhs.overflow || rhs.overflow;
+		return result;
+	}
+
+	/// Reduce the inclusive range [first, last]. 'kernel(chunk_first,
+	/// chunk_last)' reduces a non-empty inclusive sub-range and 'combine(lhs,
+	/// rhs)' merges two partial results. Both are called with chunks in
+	/// ascending order, lhs before rhs.
+	template <typename Integer, typename Result, typename Kernel, typename Combine>
+	Result parallelReduce(
+		ThreadPool& pool, Integer first, Integer last, Result identity, Kernel kernel,
+		Combine combine, std::ptrdiff_t num_chunks)
+	{
+		static_assert(std::is_integral_v<Integer>);
+		using Unsigned = std::make_unsigned_t<Integer>;
+
+		if (last < first || num_chunks <= 0)
+		{
+			return identity;
+		}
+
+		// The number of elements may not be representable in Integer, e.g.
+		// [INT64_MIN, INT64_MAX], so work with the distance in a wider type.
+		const Unsigned distance =
+			static_cast<Unsigned>(static_cast<Unsigned>(last) - static_cast<Unsigned>(first));
+		const unsigned __int128 count = static_cast<unsigned __int128>(distance) + 1;
+		num_chunks = static_cast<std::ptrdiff_t>(
+			std::min(static_cast<unsigned __int128>(num_chunks), count));
+
+		auto chunkBegin = [&](std::ptrdiff_t chunk) -> Integer {
+			const auto offset = count * static_cast<unsigned __int128>(chunk) /
+				static_cast<unsigned __int128>(num_chunks);
+			return static_cast<Integer>(static_cast<Unsigned>(first) + static_cast<Unsigned>(offset));
+		};
+
+		std::vector<CacheLinePadded<Result>> partials(
+			static_cast<std::size_t>(num_chunks), CacheLinePadded<Result> {identity});
+
+		pool.parallelFor(num_chunks, [&](std::ptrdiff_t chunk) {
+			const Integer chunk_first = chunkBegin(chunk);
+			const Integer chunk_last =
+				chunk + 1 == num_chunks ? last : static_cast<Integer>(chunkBegin(chunk + 1) - 1);
+			partials[static_cast<std::size_t>(chunk)].value = kernel(chunk_first, chunk_last);
+		});
+
+		Result result = identity;
+		for (const CacheLinePadded<Result>& partial : partials)
+		{
+			result = combine(result, partial.value);
+		}
+		return result;
+	}
+
+	/// Sum of every integer in [first, last], computed with a loop just like
+	/// 'sum_range' in signed_unsigned/from_compiler_explorer.cpp. Overflow is
+	/// detected, for unsigned types as well, instead of wrapping or being
+	/// undefined behavior. If no overflow is reported then the result is exact.
+	/// A range with both negative and positive values may report an overflow
+	/// even though the final sum fits, if a partial sum along the way doesn't.
+	template <typename Integer>
+	Checked<Integer> sumRange(
+		ThreadPool& pool, Integer first, Integer last, std::ptrdiff_t num_chunks)
+	{
+		auto kernel = [](Integer chunk_first, Integer chunk_last) {
+			Checked<Integer> sum;
+			// Written so that 'i' is never incremented past 'chunk_last', which
+			// would overflow when 'chunk_last' is the largest representable value.
+			for (Integer i = chunk_first;; ++i)
+			{
+				sum.overflow |= __builtin_add_overflow(sum.value, i, &sum.value);
+				if (i == chunk_last)
+				{
+					break;
+				}
+			}
+			return sum;
+		};
+
+		return parallelReduce(
+			pool, first, last, Checked<Integer> {}, kernel, checkedAdd<Integer>, num_chunks);
+	}
+
+	/// Four chunks per thread gives some slack for threads that are delayed by
+	/// other work on the machine.
+	template <typename Integer>
+	Checked<Integer> sumRange(ThreadPool& pool, Integer first, Integer last)
+	{
+		return sumRange(pool, first, last, 4 * std::ptrdiff_t {pool.numThreads()});
+	}
+
+	/// 1 + 2 + ... + n.
+	template <typename Integer>
+	Checked<Integer> arithmeticSeries(ThreadPool& pool, Integer n)
+	{
+		return sumRange(pool, Integer {1}, n);
+	}
+}
@@ -0,0 +1,77 @@
+#include "parallel_reduction.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+
+template <typename Integer>
+void print(const char* label, parallel_reduction::Checked<Integer> sum)
+{
+	std::cout << "  " << label << ": " << sum.value;
+	if (sum.overflow)
+	{
+		std::cout << " (overflow)";
+	}
+	std::cout << '\n';
+}
+
+// The three overloads of sum_range in signed_unsigned/from_compiler_explorer.cpp.
+// n * (n + 1) / 2 fits in all three types for n = 65535, but not in 32-bit
+// unsigned for n = 100000.
+void sum_range(ThreadPool& pool)
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	print("ptrdiff_t 65535  ", parallel_reduction::arithmeticSeries(pool, std::ptrdiff_t {65535}));
+	print("size_t    65535  ", parallel_reduction::arithmeticSeries(pool, std::size_t {65535}));
+	print("unsigned  65535  ", parallel_reduction::arithmeticSeries(pool, unsigned {65535}));
+
+	print("ptrdiff_t 100000 ", parallel_reduction::arithmeticSeries(pool, std::ptrdiff_t {100000}));
+	print("size_t    100000 ", parallel_reduction::arithmeticSeries(pool, std::size_t {100000}));
+	print("unsigned  100000 ", parallel_reduction::arithmeticSeries(pool, unsigned {100000}));
+}
+
+// Ranges at the edges of the value range. The last element is the largest
+// representable value, which a 'i <= n' loop can never terminate on.
+void edges(ThreadPool& pool)
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	constexpr std::int64_t int64_max {std::numeric_limits<std::int64_t>::max()};
+	constexpr std::int64_t int64_min {std::numeric_limits<std::int64_t>::min()};
+	constexpr std::uint64_t uint64_max {std::numeric_limits<std::uint64_t>::max()};
+
+	print("int64_t  [max - 1, max]  ", parallel_reduction::sumRange(pool, int64_max - 1, int64_max));
+	print("int64_t  [min, min + 1]  ", parallel_reduction::sumRange(pool, int64_min, int64_min + 1));
+	print("int64_t  [-1000, 1000]   ", parallel_reduction::sumRange(pool, std::int64_t {-1000}, std::int64_t {1000}));
+	print("uint64_t [max - 1, max]  ", parallel_reduction::sumRange(pool, uint64_max - 1, uint64_max));
+	print("uint64_t [max, max]      ", parallel_reduction::sumRange(pool, uint64_max, uint64_max));
+	print("uint64_t [10, 1] (empty) ", parallel_reduction::sumRange(pool, std::uint64_t {10}, std::uint64_t {1}));
+}
+
+void timing(ThreadPool& pool)
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	const std::int64_t n {200'000'000};
+	for (std::ptrdiff_t num_chunks : {std::ptrdiff_t {1}, 4 * std::ptrdiff_t {pool.numThreads()}})
+	{
+		const auto start = std::chrono::steady_clock::now();
+		const auto sum = parallel_reduction::sumRange(pool, std::int64_t {1}, n, num_chunks);
+		const auto stop = std::chrono::steady_clock::now();
+		const std::chrono::duration<double, std::milli> duration = stop - start;
+		std::cout << "  " << num_chunks << " chunks: " << sum.value << " in " << duration.count()
+				  << " ms\n";
+	}
+}
+
+int main()
+{
+	ThreadPool pool;
+	std::cout << "Threads: " << pool.numThreads() << '\n';
+	sum_range(pool);
+	edges(pool);
+	timing(pool);
+}
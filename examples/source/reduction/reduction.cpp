@@ -0,0 +1,615 @@
+#include "reduction.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define REDUCTION_X86 1
+#include <immintrin.h>
+#else
+#define REDUCTION_X86 0
+#endif
+
+namespace reduction
+{
+	namespace
+	{
+		using DoubleKernel = double (*)(const double*, std::ptrdiff_t);
+
+		// Signed and unsigned 64-bit addition produce the same bits, so a single
+		// unsigned kernel, which has well-defined wrapping, serves both.
+		using IntegerKernel = std::uint64_t (*)(const std::uint64_t*, std::ptrdiff_t);
+
+		/*
+		Helpers shared by all instruction sets. The per-lane partial sums are
+		stored to memory and combined in lane order, so the result only depends
+		on the number of lanes and not on how the kernel happened to be
+		scheduled.
+		*/
+
+		double combine(const double* lanes, int num_lanes, const double* tail, std::ptrdiff_t tail_size)
+		{
+			double sum {0.0};
+			for (int lane = 0; lane < num_lanes; ++lane)
+			{
+				sum += lanes[lane];
+			}
+			for (std::ptrdiff_t i = 0; i < tail_size; ++i)
+			{
+				sum += tail[i];
+			}
+			return sum;
+		}
+
+		struct KahanAccumulator
+		{
+			double sum {0.0};
+			double compensation {0.0};
+
+			void add(double value)
+			{
+				const double y = value - compensation;
+				const double t = sum + y;
+				compensation = (t - sum) - y;
+				sum = t;
+			}
+		};
+
+		double combineKahan(
+			const double* sums, const double* compensations, int num_lanes, const double* tail,
+			std::ptrdiff_t tail_size)
+		{
+			KahanAccumulator accumulator;
+			for (int lane = 0; lane < num_lanes; ++lane)
+			{
+				accumulator.add(sums[lane]);
+				accumulator.add(-compensations[lane]);
+			}
+			for (std::ptrdiff_t i = 0; i < tail_size; ++i)
+			{
+				accumulator.add(tail[i]);
+			}
+			return accumulator.sum;
+		}
+
+		std::uint64_t combine(
+			const std::uint64_t* lanes, int num_lanes, const std::uint64_t* tail,
+			std::ptrdiff_t tail_size)
+		{
+			std::uint64_t sum {0};
+			for (int lane = 0; lane < num_lanes; ++lane)
+			{
+				sum += lanes[lane];
+			}
+			for (std::ptrdiff_t i = 0; i < tail_size; ++i)
+			{
+				sum += tail[i];
+			}
+			return sum;
+		}
+
+		/*
+		Scalar. Used when no SIMD instruction set is available. Multiple
+		accumulators still help since they break the dependency chain between
+		consecutive additions.
+		*/
+
+		template <int N>
+		double sumScalar(const double* data, std::ptrdiff_t size)
+		{
+			double lanes[N] {};
+			std::ptrdiff_t i {0};
+			for (; i + N <= size; i += N)
+			{
+				for (int a = 0; a < N; ++a)
+				{
+					lanes[a] += data[i + a];
+				}
+			}
+			return combine(lanes, N, data + i, size - i);
+		}
+
+		template <int N>
+		double kahanScalar(const double* data, std::ptrdiff_t size)
+		{
+			double sums[N] {};
+			double compensations[N] {};
+			std::ptrdiff_t i {0};
+			for (; i + N <= size; i += N)
+			{
+				for (int a = 0; a < N; ++a)
+				{
+					const double y = data[i + a] - compensations[a];
+					const double t = sums[a] + y;
+					compensations[a] = (t - sums[a]) - y;
+					sums[a] = t;
+				}
+			}
+			return combineKahan(sums, compensations, N, data + i, size - i);
+		}
+
+		template <int N>
+		std::uint64_t integerScalar(const std::uint64_t* data, std::ptrdiff_t size)
+		{
+			std::uint64_t lanes[N] {};
+			std::ptrdiff_t i {0};
+			for (; i + N <= size; i += N)
+			{
+				for (int a = 0; a < N; ++a)
+				{
+					lanes[a] += data[i + a];
+				}
+			}
+			return combine(lanes, N, data + i, size - i);
+		}
+
+#if REDUCTION_X86
+
+		/*
+		SSE2, two doubles or two 64-bit integers per register.
+		*/
+
+#pragma GCC push_options
+#pragma GCC target("sse2")
+
+		template <int N>
+		double sumSSE2(const double* data, std::ptrdiff_t size)
+		{
+			constexpr int width {2};
+			__m128d acc[N];
+			for (int a = 0; a < N; ++a)
+			{
+				acc[a] = _mm_setzero_pd();
+			}
+			std::ptrdiff_t i {0};
+			for (; i + N * width <= size; i += N * width)
+			{
+				for (int a = 0; a < N; ++a)
+				{
+					acc[a] = _mm_add_pd(acc[a], _mm_loadu_pd(data + i + a * width));
+				}
+			}
+			double lanes[N * width];
+			for (int a = 0; a < N; ++a)
+			{
+				_mm_storeu_pd(lanes + a * width, acc[a]);
+			}
+			return combine(lanes, N * width, data + i, size - i);
+		}
+
+		template <int N>
+		double kahanSSE2(const double* data, std::ptrdiff_t size)
+		{
+			constexpr int width {2};
+			__m128d sums[N];
+			__m128d compensations[N];
+			for (int a = 0; a < N; ++a)
+			{
+				sums[a] = _mm_setzero_pd();
+				compensations[a] = _mm_setzero_pd();
+			}
+			std::ptrdiff_t i {0};
+			for (; i + N * width <= size; i += N * width)
+			{
+				for (int a = 0; a < N; ++a)
+				{
+					const __m128d y = _mm_sub_pd(_mm_loadu_pd(data + i + a * width), compensations[a]);
+					const __m128d t = _mm_add_pd(sums[a], y);
+					compensations[a] = _mm_sub_pd(_mm_sub_pd(t, sums[a]), y);
+					sums[a] = t;
+				}
+			}
+			double sum_lanes[N * width];
+			double compensation_lanes[N * width];
+			for (int a = 0; a < N; ++a)
+			{
+				_mm_storeu_pd(sum_lanes + a * width, sums[a]);
+				_mm_storeu_pd(compensation_lanes + a * width, compensations[a]);
+			}
+			return combineKahan(sum_lanes, compensation_lanes, N * width, data + i, size - i);
+		}
+
+		template <int N>
+		std::uint64_t integerSSE2(const std::uint64_t* data, std::ptrdiff_t size)
+		{
+			constexpr int width {2};
+			__m128i acc[N];
+			for (int a = 0; a < N; ++a)
+			{
+				acc[a] = _mm_setzero_si128();
+			}
+			std::ptrdiff_t i {0};
+			for (; i + N * width <= size; i += N * width)
+			{
+				for (int a = 0; a < N; ++a)
+				{
+					const __m128i values =
+						_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + a * width));
+					acc[a] = _mm_add_epi64(acc[a], values);
+				}
+			}
+			std::uint64_t lanes[N * width];
+			for (int a = 0; a < N; ++a)
+			{
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes + a * width), acc[a]);
+			}
+			return combine(lanes, N * width, data + i, size - i);
+		}
+
+#pragma GCC pop_options
+
+		/*
+		AVX2, four doubles or four 64-bit integers per register.
+		*/
+
+#pragma GCC push_options
+#pragma GCC target("avx2")
+
+		template <int N>
+		double sumAVX2(const double* data, std::ptrdiff_t size)
+		{
+			constexpr int width {4};
+			__m256d acc[N];
+			for (int a = 0; a < N; ++a)
+			{
+				acc[a] = _mm256_setzero_pd();
+			}
+			std::ptrdiff_t i {0};
+			for (; i + N * width <= size; i += N * width)
+			{
+				for (int a = 0; a < N; ++a)
+				{
+					acc[a] = _mm256_add_pd(acc[a], _mm256_loadu_pd(data + i + a * width));
+				}
+			}
+			double lanes[N * width];
+			for (int a = 0; a < N; ++a)
+			{
+				_mm256_storeu_pd(lanes + a * width, acc[a]);
+			}
+			return combine(lanes, N * width, data + i, size - i);
+		}
+
+		template <int N>
+		double kahanAVX2(const double* data, std::ptrdiff_t size)
+		{
+			constexpr int width {4};
+			__m256d sums[N];
+			__m256d compensations[N];
+			for (int a = 0; a < N; ++a)
+			{
+				sums[a] = _mm256_setzero_pd();
+				compensations[a] = _mm256_setzero_pd();
+			}
+			std::ptrdiff_t i {0};
+			for (; i + N * width <= size; i += N * width)
+			{
+				for (int a = 0; a < N; ++a)
+				{
+					const __m256d y =
+						_mm256_sub_pd(_mm256_loadu_pd(data + i + a * width), compensations[a]);
+					const __m256d t = _mm256_add_pd(sums[a], y);
+					compensations[a] = _mm256_sub_pd(_mm256_sub_pd(t, sums[a]), y);
+					sums[a] = t;
+				}
+			}
+			double sum_lanes[N * width];
+			double compensation_lanes[N * width];
+			for (int a = 0; a < N; ++a)
+			{
+				_mm256_storeu_pd(sum_lanes + a * width, sums[a]);
+				_mm256_storeu_pd(compensation_lanes + a * width, compensations[a]);
+			}
+			return combineKahan(sum_lanes, compensation_lanes, N * width, data + i, size - i);
+		}
+
+		template <int N>
+		std::uint64_t integerAVX2(const std::uint64_t* data, std::ptrdiff_t size)
+		{
+			constexpr int width {4};
+			__m256i acc[N];
+			for (int a = 0; a < N; ++a)
+			{
+				acc[a] = _mm256_setzero_si256();
+			}
+			std::ptrdiff_t i {0};
+			for (; i + N * width <= size; i += N * width)
+			{
+				for (int a = 0; a < N; ++a)
+				{
+					const __m256i values =
+						_mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + a * width));
+					acc[a] = _mm256_add_epi64(acc[a], values);
+				}
+			}
+			std::uint64_t lanes[N * width];
+			for (int a = 0; a < N; ++a)
+			{
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes + a * width), acc[a]);
+			}
+			return combine(lanes, N * width, data + i, size - i);
+		}
+
+#pragma GCC pop_options
+
+		/*
+		AVX-512, eight doubles or eight 64-bit integers per register.
+		*/
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+
+		template <int N>
+		double sumAVX512(const double* data, std::ptrdiff_t size)
+		{
+			constexpr int width {8};
+			__m512d acc[N];
+			for (int a = 0; a < N; ++a)
+			{
+				acc[a] = _mm512_setzero_pd();
+			}
+			std::ptrdiff_t i {0};
+			for (; i + N * width <= size; i += N * width)
+			{
+				for (int a = 0; a < N; ++a)
+				{
+					acc[a] = _mm512_add_pd(acc[a], _mm512_loadu_pd(data + i + a * width));
+				}
+			}
+			double lanes[N * width];
+			for (int a = 0; a < N; ++a)
+			{
+				_mm512_storeu_pd(lanes + a * width, acc[a]);
+			}
+			return combine(lanes, N * width, data + i, size - i);
+		}
+
+		template <int N>
+		double kahanAVX512(const double* data, std::ptrdiff_t size)
+		{
+			constexpr int width {8};
+			__m512d sums[N];
+			__m512d compensations[N];
+			for (int a = 0; a < N; ++a)
+			{
+				sums[a] = _mm512_setzero_pd();
+				compensations[a] = _mm512_setzero_pd();
+			}
+			std::ptrdiff_t i {0};
+			for (; i + N * width <= size; i += N * width)
+			{
+				for (int a = 0; a < N; ++a)
+				{
+					const __m512d y =
+						_mm512_sub_pd(_mm512_loadu_pd(data + i + a * width), compensations[a]);
+					const __m512d t = _mm512_add_pd(sums[a], y);
+					compensations[a] = _mm512_sub_pd(_mm512_sub_pd(t, sums[a]), y);
+					sums[a] = t;
+				}
+			}
+			double sum_lanes[N * width];
+			double compensation_lanes[N * width];
+			for (int a = 0; a < N; ++a)
+			{
+				_mm512_storeu_pd(sum_lanes + a * width, sums[a]);
+				_mm512_storeu_pd(compensation_lanes + a * width, compensations[a]);
+			}
+			return combineKahan(sum_lanes, compensation_lanes, N * width, data + i, size - i);
+		}
+
+		template <int N>
+		std::uint64_t integerAVX512(const std::uint64_t* data, std::ptrdiff_t size)
+		{
+			constexpr int width {8};
+			__m512i acc[N];
+			for (int a = 0; a < N; ++a)
+			{
+				acc[a] = _mm512_setzero_si512();
+			}
+			std::ptrdiff_t i {0};
+			for (; i + N * width <= size; i += N * width)
+			{
+				for (int a = 0; a < N; ++a)
+				{
+					acc[a] = _mm512_add_epi64(acc[a], _mm512_loadu_si512(data + i + a * width));
+				}
+			}
+			std::uint64_t lanes[N * width];
+			for (int a = 0; a < N; ++a)
+			{
+				_mm512_storeu_si512(lanes + a * width, acc[a]);
+			}
+			return combine(lanes, N * width, data + i, size - i);
+		}
+
+#pragma GCC pop_options
+
+#endif
+
+		/*
+		Dispatch.
+		*/
+
+		// One entry per supported accumulator count: 1, 2, 4, 8.
+		constexpr int NUM_ACCUMULATOR_COUNTS {4};
+
+		struct Kernels
+		{
+			DoubleKernel fast[NUM_ACCUMULATOR_COUNTS];
+			DoubleKernel kahan[NUM_ACCUMULATOR_COUNTS];
+			IntegerKernel integer[NUM_ACCUMULATOR_COUNTS];
+		};
+
+		// clang-format off
+		// Indexed by Isa.
+		const Kernels KERNELS[] {
+			{
+				{sumScalar<1>, sumScalar<2>, sumScalar<4>, sumScalar<8>},
+				{kahanScalar<1>, kahanScalar<2>, kahanScalar<4>, kahanScalar<8>},
+				{integerScalar<1>, integerScalar<2>, integerScalar<4>, integerScalar<8>}
+			},
+#if REDUCTION_X86
+			{
+				{sumSSE2<1>, sumSSE2<2>, sumSSE2<4>, sumSSE2<8>},
+				{kahanSSE2<1>, kahanSSE2<2>, kahanSSE2<4>, kahanSSE2<8>},
+				{integerSSE2<1>, integerSSE2<2>, integerSSE2<4>, integerSSE2<8>}
+			},
+			{
+				{sumAVX2<1>, sumAVX2<2>, sumAVX2<4>, sumAVX2<8>},
+				{kahanAVX2<1>, kahanAVX2<2>, kahanAVX2<4>, kahanAVX2<8>},
+				{integerAVX2<1>, integerAVX2<2>, integerAVX2<4>, integerAVX2<8>}
+			},
+			{
+				{sumAVX512<1>, sumAVX512<2>, sumAVX512<4>, sumAVX512<8>},
+				{kahanAVX512<1>, kahanAVX512<2>, kahanAVX512<4>, kahanAVX512<8>},
+				{integerAVX512<1>, integerAVX512<2>, integerAVX512<4>, integerAVX512<8>}
+			},
+#endif
+		};
+		// clang-format on
+
+		int accumulatorIndex(int num_accumulators)
+		{
+			switch (num_accumulators)
+			{
+				case 1:
+					return 0;
+				case 2:
+					return 1;
+				case 4:
+					return 2;
+				case 8:
+					return 3;
+			}
+			throw std::invalid_argument("reduction: num_accumulators must be 1, 2, 4, or 8.");
+		}
+
+		const Kernels& selectKernels(Isa requested)
+		{
+			const Isa isa = std::min(requested, activeIsa());
+			return KERNELS[static_cast<int>(isa)];
+		}
+
+		double pairwise(const double* data, std::ptrdiff_t size, DoubleKernel leaf)
+		{
+			// Large enough for the leaf kernel to run at full speed, small enough
+			// that the rounding error within a block stays small.
+			constexpr std::ptrdiff_t block_size {1024};
+			if (size <= block_size)
+			{
+				return leaf(data, size);
+			}
+
+			// Split on a block boundary so that the leaves don't get short tails.
+			const std::ptrdiff_t half = ((size / block_size + 1) / 2) * block_size;
+			return pairwise(data, half, leaf) + pairwise(data + half, size - half, leaf);
+		}
+	}
+
+	Isa detectIsa()
+	{
+#if REDUCTION_X86
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f"))
+		{
+			return Isa::AVX512;
+		}
+		if (__builtin_cpu_supports("avx2"))
+		{
+			return Isa::AVX2;
+		}
+		if (__builtin_cpu_supports("sse2"))
+		{
+			return Isa::SSE2;
+		}
+#endif
+		return Isa::Scalar;
+	}
+
+	Isa activeIsa()
+	{
+		static const Isa isa = detectIsa();
+		return isa;
+	}
+
+	bool isSupported(Isa isa)
+	{
+		return isa <= activeIsa();
+	}
+
+	const char* toString(Isa isa)
+	{
+		switch (isa)
+		{
+			case Isa::Scalar:
+				return "Scalar";
+			case Isa::SSE2:
+				return "SSE2";
+			case Isa::AVX2:
+				return "AVX2";
+			case Isa::AVX512:
+				return "AVX512";
+		}
+		return "Unknown";
+	}
+
+	const char* toString(Mode mode)
+	{
+		switch (mode)
+		{
+			case Mode::Fast:
+				return "Fast";
+			case Mode::Kahan:
+				return "Kahan";
+			case Mode::Pairwise:
+				return "Pairwise";
+		}
+		return "Unknown";
+	}
+
+	double sum(const double* data, std::ptrdiff_t size, Options options)
+	{
+		const Kernels& kernels = selectKernels(options.isa);
+		const int index = accumulatorIndex(options.num_accumulators);
+		switch (options.mode)
+		{
+			case Mode::Fast:
+				return kernels.fast[index](data, size);
+			case Mode::Kahan:
+				return kernels.kahan[index](data, size);
+			case Mode::Pairwise:
+				return pairwise(data, size, kernels.fast[index]);
+		}
+		return 0.0;
+	}
+
+	std::uint64_t sum(const std::uint64_t* data, std::ptrdiff_t size, Options options)
+	{
+		const Kernels& kernels = selectKernels(options.isa);
+		const int index = accumulatorIndex(options.num_accumulators);
+		return kernels.integer[index](data, size);
+	}
+
+	std::int64_t sum(const std::int64_t* data, std::ptrdiff_t size, Options options)
+	{
+		// Accessing an int64_t through an uint64_t glvalue is allowed by the
+		// aliasing rules, and the conversion back is modular since C++20.
+		const auto* unsigned_data = reinterpret_cast<const std::uint64_t*>(data);
+		return static_cast<std::int64_t>(sum(unsigned_data, size, options));
+	}
+
+	double average(const double* data, std::ptrdiff_t size, Options options)
+	{
+		return sum(data, size, options) / static_cast<double>(size);
+	}
+
+	double average(const std::int64_t* data, std::ptrdiff_t size, Options options)
+	{
+		return static_cast<double>(sum(data, size, options)) / static_cast<double>(size);
+	}
+
+	double average(const std::uint64_t* data, std::ptrdiff_t size, Options options)
+	{
+		return static_cast<double>(sum(data, size, options)) / static_cast<double>(size);
+	}
+}
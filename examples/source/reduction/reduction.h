@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+Reduction kernels, i.e. sum and average, over contiguous buffers.
+
+The loops in signed_unsigned/from_compiler_explorer.cpp, e.g.
+'sum(double*, int)', use a single accumulator. Floating-point addition is not
+associative so the compiler may not reorder the additions, and without
+reordering there is no way to use SIMD instructions. Every addition must wait
+for the previous one to finish.
+
+The kernels here do the reordering by hand. Each kernel keeps a configurable
+number of accumulators, each a SIMD register, and the partial sums are
+combined in a fixed order at the end. The result is deterministic for a given
+instruction set and accumulator count, but may differ in the last bits from
+the serial loop.
+
+The instruction set is detected once, the first time a kernel is called, using
+CPUID through '__builtin_cpu_supports'.
+*/
+
+namespace reduction
+{
+	/// The instruction set used by a kernel. Ordered from least to most capable.
+	enum class Isa
+	{
+		Scalar,
+		SSE2,
+		AVX2,
+		AVX512
+	};
+
+	/// How floating-point values are summed. Ignored for integer kernels.
+	enum class Mode
+	{
+		/// Multiple accumulators, plain addition.
+		Fast,
+		/// Compensated summation, one compensation term per accumulator lane.
+		Kahan,
+		/// Recursive halving down to blocks that are summed with the Fast kernel.
+		/// The rounding error grows with log(n) instead of n.
+		Pairwise
+	};
+
+	/// The most capable instruction set supported by this CPU.
+	Isa detectIsa();
+
+	/// The instruction set selected at startup. Same as detectIsa() but only
+	/// queries the CPU once.
+	Isa activeIsa();
+
+	bool isSupported(Isa isa);
+
+	const char* toString(Isa isa);
+	const char* toString(Mode mode);
+
+	struct Options
+	{
+		Mode mode {Mode::Fast};
+
+		/// Number of independent SIMD accumulators. Must be 1, 2, 4, or 8.
+		int num_accumulators {4};
+
+		/// Requesting an instruction set the CPU doesn't support selects the
+		/// most capable one that is supported.
+		Isa isa {Isa::AVX512};
+	};
+
+	double sum(const double* data, std::ptrdiff_t size, Options options = {});
+
+	/// Integer sums wrap on overflow, just like the loops they replace.
+	std::int64_t sum(const std::int64_t* data, std::ptrdiff_t size, Options options = {});
+	std::uint64_t sum(const std::uint64_t* data, std::ptrdiff_t size, Options options = {});
+
+	double average(const double* data, std::ptrdiff_t size, Options options = {});
+	double average(const std::int64_t* data, std::ptrdiff_t size, Options options = {});
+	double average(const std::uint64_t* data, std::ptrdiff_t size, Options options = {});
+}
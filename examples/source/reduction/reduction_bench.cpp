@@ -0,0 +1,113 @@
+/*
+Compares the reduction kernels against the single accumulator loop.
+
+  ./build/reduction/reduction_bench --benchmark_out=reduction.json --benchmark_out_format=json
+
+The arguments are buffer size, instruction set, mode, and number of
+accumulators. Instruction sets not supported by the CPU are reported as
+errors.
+*/
+
+#include "reduction.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <vector>
+
+__attribute((noinline)) double serial_sum(const double* data, std::ptrdiff_t size)
+{
+	double sum {0.0};
+	for (std::ptrdiff_t index = 0; index < size; ++index)
+	{
+		sum += data[index];
+	}
+	return sum;
+}
+
+template <typename T>
+std::vector<T> getBuffer(std::int64_t size)
+{
+	std::vector<T> buffer(static_cast<std::size_t>(size));
+	std::iota(buffer.begin(), buffer.end(), T {1});
+	return buffer;
+}
+
+static void Serial(benchmark::State& state)
+{
+	std::vector<double> buffer = getBuffer<double>(state.range(0));
+	for (auto _ : state)
+	{
+		double s = serial_sum(buffer.data(), std::ssize(buffer));
+		benchmark::DoNotOptimize(s);
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0) * std::int64_t(sizeof(double)));
+}
+
+reduction::Options getOptions(benchmark::State& state)
+{
+	reduction::Options options;
+	options.isa = static_cast<reduction::Isa>(state.range(1));
+	options.mode = static_cast<reduction::Mode>(state.range(2));
+	options.num_accumulators = static_cast<int>(state.range(3));
+	if (!reduction::isSupported(options.isa))
+	{
+		state.SkipWithError("Instruction set not supported by this CPU.");
+	}
+	state.SetLabel(
+		std::string(reduction::toString(options.isa)) + '/' + reduction::toString(options.mode));
+	return options;
+}
+
+static void SumDouble(benchmark::State& state)
+{
+	const reduction::Options options = getOptions(state);
+	std::vector<double> buffer = getBuffer<double>(state.range(0));
+	for (auto _ : state)
+	{
+		double s = reduction::sum(buffer.data(), std::ssize(buffer), options);
+		benchmark::DoNotOptimize(s);
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0) * std::int64_t(sizeof(double)));
+}
+
+static void AverageInt64(benchmark::State& state)
+{
+	const reduction::Options options = getOptions(state);
+	std::vector<std::int64_t> buffer = getBuffer<std::int64_t>(state.range(0));
+	for (auto _ : state)
+	{
+		double a = reduction::average(buffer.data(), std::ssize(buffer), options);
+		benchmark::DoNotOptimize(a);
+	}
+	state.SetBytesProcessed(
+		state.iterations() * state.range(0) * std::int64_t(sizeof(std::int64_t)));
+}
+
+constexpr std::int64_t SCALAR {static_cast<std::int64_t>(reduction::Isa::Scalar)};
+constexpr std::int64_t AVX512 {static_cast<std::int64_t>(reduction::Isa::AVX512)};
+constexpr std::int64_t FAST {static_cast<std::int64_t>(reduction::Mode::Fast)};
+constexpr std::int64_t PAIRWISE {static_cast<std::int64_t>(reduction::Mode::Pairwise)};
+
+// clang-format off
+BENCHMARK(Serial)
+	->RangeMultiplier(8)->Range(1 << 10, 1 << 24);
+BENCHMARK(SumDouble)
+	->ArgNames({"size", "isa", "mode", "accumulators"})
+	->ArgsProduct({
+		benchmark::CreateRange(1 << 10, 1 << 24, 8),
+		benchmark::CreateDenseRange(SCALAR, AVX512, 1),
+		benchmark::CreateDenseRange(FAST, PAIRWISE, 1),
+		{1, 2, 4, 8}});
+BENCHMARK(AverageInt64)
+	->ArgNames({"size", "isa", "mode", "accumulators"})
+	->ArgsProduct({
+		benchmark::CreateRange(1 << 10, 1 << 24, 8),
+		benchmark::CreateDenseRange(SCALAR, AVX512, 1),
+		{FAST},
+		{1, 4}});
+// clang-format on
+
+BENCHMARK_MAIN();
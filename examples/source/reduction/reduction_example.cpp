@@ -0,0 +1,79 @@
+#include "reduction.h"
+
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+// The single accumulator loop from signed_unsigned/from_compiler_explorer.cpp.
+__attribute((noinline)) double serial_sum(const double* data, std::ptrdiff_t size)
+{
+	double sum {0.0};
+	for (std::ptrdiff_t index = 0; index < size; ++index)
+	{
+		sum += data[index];
+	}
+	return sum;
+}
+
+void compare_isas_and_modes()
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	// 0.1 cannot be represented exactly, so every addition rounds. With a
+	// single accumulator the rounding errors pile up. The exact sum is 100000.
+	std::vector<double> data(1'000'000, 0.1);
+	const auto size = std::ssize(data);
+
+	std::cout << std::setprecision(17);
+	std::cout << "  serial:                " << serial_sum(data.data(), size) << '\n';
+
+	for (reduction::Isa isa :
+		 {reduction::Isa::Scalar, reduction::Isa::SSE2, reduction::Isa::AVX2,
+		  reduction::Isa::AVX512})
+	{
+		if (!reduction::isSupported(isa))
+		{
+			std::cout << "  " << reduction::toString(isa) << ": not supported by this CPU.\n";
+			continue;
+		}
+
+		for (reduction::Mode mode :
+			 {reduction::Mode::Fast, reduction::Mode::Kahan, reduction::Mode::Pairwise})
+		{
+			for (int num_accumulators : {1, 4})
+			{
+				reduction::Options options;
+				options.isa = isa;
+				options.mode = mode;
+				options.num_accumulators = num_accumulators;
+				std::cout << "  " << std::setw(6) << reduction::toString(isa) << ' '
+						  << std::setw(8) << reduction::toString(mode) << " x" << num_accumulators
+						  << ": " << reduction::sum(data.data(), size, options) << '\n';
+			}
+		}
+	}
+}
+
+void integer_average()
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	std::vector<std::int64_t> signed_data(1001);
+	std::iota(signed_data.begin(), signed_data.end(), -500);
+	std::cout << "  average(int64_t):  "
+			  << reduction::average(signed_data.data(), std::ssize(signed_data)) << '\n';
+
+	std::vector<std::uint64_t> unsigned_data(1001);
+	std::iota(unsigned_data.begin(), unsigned_data.end(), 0);
+	std::cout << "  average(uint64_t): "
+			  << reduction::average(unsigned_data.data(), std::ssize(unsigned_data)) << '\n';
+}
+
+int main()
+{
+	std::cout << "Detected instruction set: " << reduction::toString(reduction::activeIsa()) << '\n';
+	compare_isas_and_modes();
+	integer_average();
+}
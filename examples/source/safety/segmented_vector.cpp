@@ -0,0 +1,109 @@
+#include "segmented_vector.h"
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+// The same work loop as in iterator_invalidation.cpp, without the 'reserve'.
+
+const int SENTINEL = 0;
+
+void collect_work(SegmentedVector<int>& container)
+{
+	// Enough to allocate several new blocks.
+	for (int i = 0; i < 1000; ++i)
+	{
+		container.push_back(9);
+	}
+}
+
+void work(SegmentedVector<int>& container)
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	container.push_back(SENTINEL);
+	// Elements don't move, so this pointer stays valid.
+	int* sentinel_it = &container.back();
+	collect_work(container);
+	int num_processed {0};
+	while (&container.back() != sentinel_it)
+	{
+		// Do work on 'container'.
+		container.pop_back();
+		++num_processed;
+	}
+	std::cout << "  Processed " << num_processed << " items, sentinel still " << *sentinel_it
+			  << '\n';
+}
+
+/// Longest single push_back while growing to 'num_elements'.
+template <typename Container>
+double worstPushBackMicroseconds(int num_elements)
+{
+	Container container;
+	double worst {0.0};
+	for (int i = 0; i < num_elements; ++i)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		container.push_back(i);
+		const auto stop = std::chrono::steady_clock::now();
+		worst = std::max(worst, std::chrono::duration<double, std::micro>(stop - start).count());
+	}
+	return worst;
+}
+
+void growth_latency()
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	constexpr int num_elements {20'000'000};
+	std::cout << "  Slowest push_back, std::vector:     "
+			  << worstPushBackMicroseconds<std::vector<int>>(num_elements) << " us\n";
+	std::cout << "  Slowest push_back, SegmentedVector: "
+			  << worstPushBackMicroseconds<SegmentedVector<int>>(num_elements) << " us\n";
+}
+
+void parallel_sum()
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	SegmentedVector<long long> values;
+	for (int i = 0; i < 10'000'000; ++i)
+	{
+		values.push_back(i);
+	}
+
+	// Split the index range evenly, each task walks the blocks its range spans.
+	ThreadPool pool;
+	const std::ptrdiff_t num_tasks {pool.numThreads() * 4};
+	std::vector<long long> partial_sums(static_cast<std::size_t>(num_tasks));
+	pool.parallelFor(num_tasks, [&](std::ptrdiff_t task) {
+		const std::ptrdiff_t first = values.size() * task / num_tasks;
+		const std::ptrdiff_t last = values.size() * (task + 1) / num_tasks;
+		long long sum {0};
+		values.forEachSegment(first, last, [&sum](std::span<long long> segment) {
+			sum = std::accumulate(segment.begin(), segment.end(), sum);
+		});
+		partial_sums[static_cast<std::size_t>(task)] = sum;
+	});
+
+	const long long sum = std::accumulate(partial_sums.begin(), partial_sums.end(), 0LL);
+	// The iterators are random access, so the standard algorithms work as well.
+	const long long serial_sum = std::accumulate(values.begin(), values.end(), 0LL);
+	std::cout << "  Parallel sum " << sum << ", serial sum " << serial_sum << '\n';
+}
+
+int main()
+{
+	SegmentedVector<int> container;
+	for (int value : {1, 2, 3})
+	{
+		container.push_back(value);
+	}
+	work(container);
+	growth_latency();
+	parallel_sum();
+}
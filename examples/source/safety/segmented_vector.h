@@ -0,0 +1,369 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+/*
+A growable array whose elements never move.
+
+std::vector grows by allocating a larger buffer and moving every element over,
+which invalidates all pointers into it and makes that one push_back O(n). This
+is why 'work' in safety/iterator_invalidation.cpp needs the 'reserve'. The
+copies also show up as latency spikes in code that is otherwise fast.
+
+A SegmentedVector instead allocates a new block whenever the existing ones are
+full and leaves the old blocks where they are. Block k holds
+FIRST_BLOCK_SIZE * 2^k elements, so the number of blocks grows with the
+logarithm of the size and the table of block pointers is a fixed-size array
+that never reallocates either. With the sizes being powers of two, the block
+and offset of an index are computed with a bit width and a subtraction, there
+is no search.
+
+- push_back is O(1) in the worst case, not just amortized, and never copies
+  existing elements.
+- Pointers and references to elements stay valid until the element is popped.
+- Random access costs a few more instructions than for a std::vector.
+  Iterating by segment, see 'forEachSegment', is as fast as iterating over a
+  std::vector within each block.
+*/
+
+template <typename T, int FirstBlockBits = 6>
+class SegmentedVector
+{
+	static_assert(FirstBlockBits >= 0 && FirstBlockBits < 32);
+
+public:
+	static constexpr std::ptrdiff_t FIRST_BLOCK_SIZE {std::ptrdiff_t {1} << FirstBlockBits};
+	static constexpr int MAX_BLOCKS {48};
+
+	template <bool Const>
+	class Iterator;
+
+	using iterator = Iterator<false>;
+	using const_iterator = Iterator<true>;
+
+	SegmentedVector() = default;
+
+	~SegmentedVector()
+	{
+		clear();
+		for (int block = 0; block < MAX_BLOCKS; ++block)
+		{
+			::operator delete(m_blocks[block], std::align_val_t {alignof(T)});
+		}
+	}
+
+	SegmentedVector(SegmentedVector&& other) noexcept
+		: m_blocks(std::exchange(other.m_blocks, {}))
+		, m_size(std::exchange(other.m_size, 0))
+	{
+	}
+
+	SegmentedVector& operator=(SegmentedVector&& other) noexcept
+	{
+		SegmentedVector(std::move(other)).swap(*this);
+		return *this;
+	}
+
+	SegmentedVector(const SegmentedVector&) = delete;
+	SegmentedVector& operator=(const SegmentedVector&) = delete;
+
+	void swap(SegmentedVector& other) noexcept
+	{
+		std::swap(m_blocks, other.m_blocks);
+		std::swap(m_size, other.m_size);
+	}
+
+	std::ptrdiff_t size() const
+	{
+		return m_size;
+	}
+
+	bool empty() const
+	{
+		return m_size == 0;
+	}
+
+	/// Number of elements that fit in the blocks allocated so far.
+	std::ptrdiff_t capacity() const
+	{
+		int num_blocks {0};
+		while (num_blocks < MAX_BLOCKS && m_blocks[num_blocks] != nullptr)
+		{
+			++num_blocks;
+		}
+		return blockStart(num_blocks);
+	}
+
+	template <typename... Args>
+	T& emplace_back(Args&&... args)
+	{
+		const auto [block, offset] = locate(m_size);
+		if (offset == 0 && m_blocks[block] == nullptr)
+		{
+			assert(block < MAX_BLOCKS);
+			const auto block_bytes = static_cast<std::size_t>(blockSize(block)) * sizeof(T);
+			m_blocks[block] =
+				static_cast<T*>(::operator new(block_bytes, std::align_val_t {alignof(T)}));
+		}
+		T* element = ::new (m_blocks[block] + offset) T(std::forward<Args>(args)...);
+		++m_size;
+		return *element;
+	}
+
+	void push_back(const T& value)
+	{
+		emplace_back(value);
+	}
+
+	void push_back(T&& value)
+	{
+		emplace_back(std::move(value));
+	}
+
+	void pop_back()
+	{
+		assert(m_size > 0);
+		std::destroy_at(&back());
+		--m_size;
+	}
+
+	/// Destroy all elements. The blocks are kept for reuse.
+	void clear()
+	{
+		forEachSegment(
+			0, m_size, [](std::span<T> segment) { std::destroy(segment.begin(), segment.end()); });
+		m_size = 0;
+	}
+
+	T& operator[](std::ptrdiff_t index)
+	{
+		assert(index >= 0 && index < m_size);
+		const auto [block, offset] = locate(index);
+		return m_blocks[block][offset];
+	}
+
+	const T& operator[](std::ptrdiff_t index) const
+	{
+		assert(index >= 0 && index < m_size);
+		const auto [block, offset] = locate(index);
+		return m_blocks[block][offset];
+	}
+
+	T& back()
+	{
+		return (*this)[m_size - 1];
+	}
+
+	const T& back() const
+	{
+		return (*this)[m_size - 1];
+	}
+
+	/// Call 'function(segment)' with the contiguous pieces of [first, last),
+	/// in order. Ranges split into pieces like this are what to hand to the
+	/// threads of a parallel loop.
+	template <typename Function>
+	void forEachSegment(std::ptrdiff_t first, std::ptrdiff_t last, Function function)
+	{
+		forEachSegmentImpl(*this, first, last, function);
+	}
+
+	template <typename Function>
+	void forEachSegment(std::ptrdiff_t first, std::ptrdiff_t last, Function function) const
+	{
+		forEachSegmentImpl(*this, first, last, function);
+	}
+
+	iterator begin()
+	{
+		return {this, 0};
+	}
+
+	iterator end()
+	{
+		return {this, m_size};
+	}
+
+	const_iterator begin() const
+	{
+		return {this, 0};
+	}
+
+	const_iterator end() const
+	{
+		return {this, m_size};
+	}
+
+	template <bool Const>
+	class Iterator
+	{
+	public:
+		using iterator_category = std::random_access_iterator_tag;
+		using iterator_concept = std::random_access_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = std::conditional_t<Const, const T*, T*>;
+		using reference = std::conditional_t<Const, const T&, T&>;
+		using Container = std::conditional_t<Const, const SegmentedVector, SegmentedVector>;
+
+		Iterator() = default;
+
+		Iterator(Container* container, std::ptrdiff_t index)
+			: m_container(container)
+			, m_index(index)
+		{
+		}
+
+		/// iterator converts to const_iterator.
+		operator Iterator<true>() const
+			requires(!Const)
+		{
+			return {m_container, m_index};
+		}
+
+		reference operator*() const
+		{
+			return (*m_container)[m_index];
+		}
+
+		pointer operator->() const
+		{
+			return &(*m_container)[m_index];
+		}
+
+		reference operator[](difference_type offset) const
+		{
+			return (*m_container)[m_index + offset];
+		}
+
+		Iterator& operator++()
+		{
+			++m_index;
+			return *this;
+		}
+
+		Iterator operator++(int)
+		{
+			Iterator previous = *this;
+			++m_index;
+			return previous;
+		}
+
+		Iterator& operator--()
+		{
+			--m_index;
+			return *this;
+		}
+
+		Iterator operator--(int)
+		{
+			Iterator previous = *this;
+			--m_index;
+			return previous;
+		}
+
+		Iterator& operator+=(difference_type offset)
+		{
+			m_index += offset;
+			return *this;
+		}
+
+		Iterator& operator-=(difference_type offset)
+		{
+			m_index -= offset;
+			return *this;
+		}
+
+		friend Iterator operator+(Iterator it, difference_type offset)
+		{
+			return it += offset;
+		}
+
+		friend Iterator operator+(difference_type offset, Iterator it)
+		{
+			return it += offset;
+		}
+
+		friend Iterator operator-(Iterator it, difference_type offset)
+		{
+			return it -= offset;
+		}
+
+		friend difference_type operator-(const Iterator& lhs, const Iterator& rhs)
+		{
+			return lhs.m_index - rhs.m_index;
+		}
+
+		friend bool operator==(const Iterator& lhs, const Iterator& rhs)
+		{
+			return lhs.m_index == rhs.m_index;
+		}
+
+		friend std::strong_ordering operator<=>(const Iterator& lhs, const Iterator& rhs)
+		{
+			return lhs.m_index <=> rhs.m_index;
+		}
+
+	private:
+		Container* m_container {nullptr};
+		std::ptrdiff_t m_index {0};
+	};
+
+private:
+	struct Location
+	{
+		int block;
+		std::ptrdiff_t offset;
+	};
+
+	static constexpr std::ptrdiff_t blockSize(int block)
+	{
+		return FIRST_BLOCK_SIZE << block;
+	}
+
+	/// Index of the first element in 'block'.
+	static constexpr std::ptrdiff_t blockStart(int block)
+	{
+		return FIRST_BLOCK_SIZE * ((std::ptrdiff_t {1} << block) - 1);
+	}
+
+	static Location locate(std::ptrdiff_t index)
+	{
+		// Block k covers [F * (2^k - 1), F * (2^(k+1) - 1)), so index + F is in
+		// [F * 2^k, F * 2^(k+1)) and its highest set bit is k + log2(F).
+		const auto shifted = static_cast<std::size_t>(index + FIRST_BLOCK_SIZE);
+		const int block = static_cast<int>(std::bit_width(shifted)) - 1 - FirstBlockBits;
+		return {block, static_cast<std::ptrdiff_t>(shifted) - (FIRST_BLOCK_SIZE << block)};
+	}
+
+	template <typename Self, typename Function>
+	static void forEachSegmentImpl(
+		Self& self, std::ptrdiff_t first, std::ptrdiff_t last, Function& function)
+	{
+		using Element = std::conditional_t<std::is_const_v<Self>, const T, T>;
+		assert(first >= 0 && first <= last && last <= self.m_size);
+		while (first < last)
+		{
+			const auto [block, offset] = locate(first);
+			const std::ptrdiff_t count = std::min(blockSize(block) - offset, last - first);
+			function(
+				std::span<Element>(self.m_blocks[block] + offset, static_cast<std::size_t>(count)));
+			first += count;
+		}
+	}
+
+private:
+	std::array<T*, MAX_BLOCKS> m_blocks {};
+	std::ptrdiff_t m_size {0};
+};
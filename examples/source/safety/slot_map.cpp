@@ -0,0 +1,129 @@
+#include "slot_map.h"
+
+#include <chrono>
+#include <iostream>
+#include <list>
+#include <numeric>
+
+// The same work loop as in iterator_invalidation.cpp, with the iterator to the
+// sentinel replaced by a handle. No reserve is needed.
+
+using WorkList = SlotMap<int>;
+
+const int SENTINEL = 0;
+
+template <typename Function>
+double milliseconds(Function function)
+{
+	const auto start = std::chrono::steady_clock::now();
+	function();
+	const auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+void collect_work(WorkList& container)
+{
+	// Enough to reallocate the dense array several times.
+	for (int i = 0; i < 100; ++i)
+	{
+		container.insert(9);
+	}
+}
+
+void work(WorkList& container)
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	// Positions in the dense array, not pointers. A pointer into the array
+	// dangles once collect_work reallocates it, and can't even be compared.
+	auto position = [&container](WorkList::Handle handle) {
+		return container.find(handle) - container.values().data();
+	};
+	const WorkList::Handle sentinel = container.insert(SENTINEL);
+	const std::ptrdiff_t position_before = position(sentinel);
+	collect_work(container);
+	// The handle still refers to the sentinel, although the array it is in
+	// has been reallocated.
+	std::cout << "  Sentinel at position " << position_before << ", now at "
+			  << position(sentinel) << ", still found: " << (container[sentinel] == SENTINEL)
+			  << '\n';
+
+	int num_processed {0};
+	while (container.contains(sentinel))
+	{
+		// Do work on 'container', the last element first.
+		const WorkList::Handle last = container.handleAt(container.size() - 1);
+		if (last == sentinel)
+		{
+			container.erase(sentinel);
+		}
+		else
+		{
+			container.erase(last);
+			++num_processed;
+		}
+	}
+	std::cout << "  Processed " << num_processed << " items, " << container.size()
+			  << " left from before the sentinel\n";
+}
+
+void stale_handles()
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	WorkList work_list;
+	const WorkList::Handle first = work_list.insert(1);
+	work_list.erase(first);
+	// Reuses the slot of 'first', with a new generation.
+	const WorkList::Handle second = work_list.insert(2);
+	std::cout << "  Same slot: " << (first.slot == second.slot)
+			  << ", old handle finds: " << work_list.find(first)
+			  << ", new handle finds: " << *work_list.find(second) << '\n';
+}
+
+void iteration_versus_list()
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	constexpr int num_elements {5'000'000};
+	WorkList slot_map;
+	std::list<int> list;
+	std::vector<WorkList::Handle> handles;
+	for (int i = 0; i < num_elements; ++i)
+	{
+		handles.push_back(slot_map.insert(i));
+		list.push_back(i);
+	}
+	// Remove every third element so the slot map has holes to fill and
+	// elements out of insertion order.
+	for (std::size_t i = 0; i < handles.size(); i += 3)
+	{
+		slot_map.erase(handles[i]);
+	}
+	for (auto it = list.begin(); it != list.end();)
+	{
+		it = *it % 3 == 0 ? list.erase(it) : std::next(it);
+	}
+
+	long long slot_map_sum {0};
+	long long list_sum {0};
+	const double slot_map_ms = milliseconds(
+		[&]() { slot_map_sum = std::accumulate(slot_map.begin(), slot_map.end(), 0LL); });
+	const double list_ms =
+		milliseconds([&]() { list_sum = std::accumulate(list.begin(), list.end(), 0LL); });
+	std::cout << "  SlotMap:   " << slot_map_ms << " ms\n";
+	std::cout << "  std::list: " << list_ms << " ms\n";
+	std::cout << "  Same sum: " << (slot_map_sum == list_sum) << '\n';
+}
+
+int main()
+{
+	WorkList container;
+	for (int value : {1, 2, 3})
+	{
+		container.insert(value);
+	}
+	work(container);
+	stale_handles();
+	iteration_versus_list();
+}
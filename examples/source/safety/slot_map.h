@@ -0,0 +1,202 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+
+/*
+A container that hands out handles instead of pointers or iterators.
+
+Keeping a pointer or iterator into a std::vector across a push_back is the
+bug in safety/iterator_invalidation.cpp: the push_back may reallocate and the
+pointer then dangles. std::list and std::deque avoid that by never moving
+elements, but iterating over them chases a pointer per element or per block.
+
+A SlotMap stores its elements densely in a std::vector, which may reallocate
+and reorder freely, and gives out a Handle for every element. The handle is an
+index into a second array, the slots, which in turn holds the element's
+current position in the dense array. A handle therefore stays valid across any
+amount of growth and across the removal of other elements.
+
+Every slot also has a generation that is bumped when its element is removed.
+A handle to a removed element has an old generation and is detected as stale
+instead of silently referring to whatever element reuses the slot. The
+generation is odd while the slot is in use, so a slot needs no separate flag.
+
+Removal moves the last element into the hole, so iteration order is not
+insertion order.
+*/
+
+template <typename T>
+class SlotMap
+{
+public:
+	struct Handle
+	{
+		std::uint32_t slot {INVALID};
+		std::uint32_t generation {0};
+
+		friend bool operator==(Handle, Handle) = default;
+	};
+
+	std::ptrdiff_t size() const
+	{
+		return std::ssize(m_values);
+	}
+
+	bool empty() const
+	{
+		return m_values.empty();
+	}
+
+	void reserve(std::ptrdiff_t capacity)
+	{
+		m_values.reserve(static_cast<std::size_t>(capacity));
+		m_value_slots.reserve(static_cast<std::size_t>(capacity));
+		m_slots.reserve(static_cast<std::size_t>(capacity));
+	}
+
+	Handle insert(T value)
+	{
+		const std::uint32_t slot_index = allocateSlot();
+		Slot& slot = m_slots[slot_index];
+		slot.position = static_cast<std::uint32_t>(m_values.size());
+		++slot.generation;
+		m_values.push_back(std::move(value));
+		m_value_slots.push_back(slot_index);
+		return {slot_index, slot.generation};
+	}
+
+	/// Remove the element 'handle' refers to. Returns false if the handle is stale.
+	bool erase(Handle handle)
+	{
+		if (!contains(handle))
+		{
+			return false;
+		}
+
+		Slot& slot = m_slots[handle.slot];
+		const std::uint32_t position = slot.position;
+		const std::uint32_t last = static_cast<std::uint32_t>(m_values.size() - 1);
+		if (position != last)
+		{
+			m_values[position] = std::move(m_values[last]);
+			m_value_slots[position] = m_value_slots[last];
+			m_slots[m_value_slots[position]].position = position;
+		}
+		m_values.pop_back();
+		m_value_slots.pop_back();
+
+		++slot.generation;
+		slot.position = m_free_head;
+		m_free_head = handle.slot;
+		return true;
+	}
+
+	bool contains(Handle handle) const
+	{
+		return handle.slot < m_slots.size() &&
+			   m_slots[handle.slot].generation == handle.generation &&
+			   (handle.generation & 1) == 1;
+	}
+
+	/// The element 'handle' refers to, or nullptr if the handle is stale.
+	T* find(Handle handle)
+	{
+		return contains(handle) ? &m_values[m_slots[handle.slot].position] : nullptr;
+	}
+
+	const T* find(Handle handle) const
+	{
+		return contains(handle) ? &m_values[m_slots[handle.slot].position] : nullptr;
+	}
+
+	T& operator[](Handle handle)
+	{
+		assert(contains(handle));
+		return m_values[m_slots[handle.slot].position];
+	}
+
+	const T& operator[](Handle handle) const
+	{
+		assert(contains(handle));
+		return m_values[m_slots[handle.slot].position];
+	}
+
+	/// The handle of the element currently at 'position' in the dense array.
+	Handle handleAt(std::ptrdiff_t position) const
+	{
+		assert(position >= 0 && position < size());
+		const std::uint32_t slot = m_value_slots[static_cast<std::size_t>(position)];
+		return {slot, m_slots[slot].generation};
+	}
+
+	/// All elements, contiguous. Valid until the next insert or erase.
+	std::span<T> values()
+	{
+		return m_values;
+	}
+
+	std::span<const T> values() const
+	{
+		return m_values;
+	}
+
+	auto begin()
+	{
+		return m_values.begin();
+	}
+
+	auto end()
+	{
+		return m_values.end();
+	}
+
+	auto begin() const
+	{
+		return m_values.begin();
+	}
+
+	auto end() const
+	{
+		return m_values.end();
+	}
+
+private:
+	static constexpr std::uint32_t INVALID {std::numeric_limits<std::uint32_t>::max()};
+
+	struct Slot
+	{
+		/// While in use, the element's position in 'm_values'. While free, the
+		/// index of the next free slot.
+		std::uint32_t position {INVALID};
+		/// Odd while in use.
+		std::uint32_t generation {0};
+	};
+
+	std::uint32_t allocateSlot()
+	{
+		if (m_free_head != INVALID)
+		{
+			const std::uint32_t slot = m_free_head;
+			m_free_head = m_slots[slot].position;
+			return slot;
+		}
+		assert(m_slots.size() < INVALID);
+		m_slots.push_back({});
+		return static_cast<std::uint32_t>(m_slots.size() - 1);
+	}
+
+private:
+	std::vector<T> m_values;
+	/// The slot of every element in 'm_values', for fixing up the slot when an
+	/// element is moved.
+	std::vector<std::uint32_t> m_value_slots;
+	std::vector<Slot> m_slots;
+	std::uint32_t m_free_head {INVALID};
+};
@@ -0,0 +1,160 @@
+#include "work_queue.h"
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+// The same work loop as in iterator_invalidation.cpp, with the sentinel
+// replaced by an epoch and the std::vector by a WorkQueue.
+
+using Queue = WorkQueue<int>;
+
+void collect_work(Queue& queue)
+{
+	// Add the next batch of work to the queue. The priority takes the place of
+	// the commented-out std::sort.
+	std::vector<int> batch {4, 5, 6};
+	queue.pushBatch(batch, 1);
+	queue.push(9, 3);
+}
+
+void work(Queue& queue)
+{
+	// Closing the epoch takes the place of pushing the sentinel: whatever is
+	// already in the queue belongs to the epoch that ends here.
+	queue.closeEpoch();
+	collect_work(queue);
+	// Everything collected belongs to this epoch.
+	const std::uint64_t epoch = queue.closeEpoch();
+	// Like the loop down to the sentinel, stop once the collected work is done.
+	// Earlier items of a lower priority stay in the queue, items of a higher
+	// priority would be processed along the way.
+	queue.drainUntilDone(epoch, [](int value) { std::cout << ' ' << value; });
+}
+
+void single_thread()
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	Queue queue(16);
+	for (int value : {1, 2, 3})
+	{
+		queue.push(value);
+	}
+	std::cout << "  Processed:";
+	work(queue);
+	std::cout << "\n  Left in the queue:";
+	for (Queue::Item item; queue.tryPop(item);)
+	{
+		std::cout << ' ' << item.value;
+		queue.finish(item);
+	}
+	std::cout << '\n';
+}
+
+void producers_and_consumers()
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	constexpr int num_producers {4};
+	constexpr int num_consumers {4};
+	constexpr int items_per_producer {100'000};
+	constexpr int batch_size {64};
+
+	// Smaller than the total amount of work, so producers regularly find the
+	// queue full and have to wait for the consumers.
+	Queue queue(1024);
+	std::atomic<std::int64_t> processed_sum {0};
+	std::atomic<std::int64_t> processed_count {0};
+	std::atomic<bool> producing {true};
+
+	std::vector<std::thread> consumers;
+	for (int consumer = 0; consumer < num_consumers; ++consumer)
+	{
+		consumers.emplace_back([&]() {
+			Queue::Item items[batch_size];
+			std::int64_t sum {0};
+			std::int64_t count {0};
+			for (;;)
+			{
+				const std::ptrdiff_t num_popped = queue.popBatch(items);
+				if (num_popped == 0)
+				{
+					if (!producing.load())
+					{
+						break;
+					}
+					std::this_thread::yield();
+					continue;
+				}
+				for (std::ptrdiff_t i = 0; i < num_popped; ++i)
+				{
+					sum += items[i].value;
+				}
+				count += num_popped;
+				queue.finish(
+					std::span<const Queue::Item>(items, static_cast<std::size_t>(num_popped)));
+			}
+			processed_sum += sum;
+			processed_count += count;
+		});
+	}
+
+	std::vector<std::thread> producers;
+	for (int producer = 0; producer < num_producers; ++producer)
+	{
+		producers.emplace_back([&queue, producer]() {
+			std::vector<int> batch;
+			for (int i = 0; i < items_per_producer; i += batch_size)
+			{
+				batch.clear();
+				for (int j = i; j < i + batch_size && j < items_per_producer; ++j)
+				{
+					batch.push_back(j);
+				}
+				std::span<int> remaining(batch);
+				while (!remaining.empty())
+				{
+					const std::ptrdiff_t num_pushed =
+						queue.pushBatch(remaining, producer % Queue::NUM_PRIORITIES);
+					remaining = remaining.subspan(static_cast<std::size_t>(num_pushed));
+					if (num_pushed == 0)
+					{
+						std::this_thread::yield();
+					}
+				}
+			}
+		});
+	}
+
+	for (std::thread& producer : producers)
+	{
+		producer.join();
+	}
+	const std::uint64_t epoch = queue.closeEpoch();
+	// Wait for the consumers to finish the epoch rather than checking for an
+	// end marker in the data.
+	while (!queue.isDone(epoch))
+	{
+		std::this_thread::yield();
+	}
+	producing = false;
+	for (std::thread& consumer : consumers)
+	{
+		consumer.join();
+	}
+
+	const std::int64_t expected_sum =
+		std::int64_t {num_producers} * items_per_producer * (items_per_producer - 1) / 2;
+	std::cout << "  Processed " << processed_count << " items, expected "
+			  << std::int64_t {num_producers} * items_per_producer << '\n';
+	std::cout << "  Sum " << processed_sum << ", expected " << expected_sum << '\n';
+}
+
+int main()
+{
+	single_thread();
+	producers_and_consumers();
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+/*
+Midpoints and averages of 64-bit integers that never overflow.
+
+'add_and_divide_by_two' in signed_unsigned.cpp computes (a + b) / 2, and a + b
+overflows when both are large. 'average' in from_compiler_explorer.cpp adds
+up the whole array in an int64_t first, which overflows long before the
+average itself would be out of range. Both are silently wrong.
+
+The midpoint is computed from the bits that a and b have in common and the
+bits where they differ, a + b = 2 * (a & b) + (a ^ b), so
+
+	(a + b) / 2 = (a & b) + ((a ^ b) >> 1)
+
+rounded down, without ever forming a + b. That is three bit operations and
+an add, and it vectorizes. A correction of one for odd negative sums gives
+the same rounding towards zero as integer division.
+
+The exact sum of n 64-bit values needs 64 + log2(n) bits. An __int128
+accumulator would do, but 128-bit additions don't vectorize. Instead every
+value is split into its low and high 32 bits, and the halves are summed
+separately in 64-bit accumulators. Neither can overflow for up to 2^32
+values, and both are plain 64-bit sums that the compiler vectorizes. The sum
+of the low halves doesn't even need its own accumulator, it can be recovered
+from the high halves and the ordinary, wrapping, 64-bit sum.
+The two partial sums are combined into a 128-bit sum once at the end, per
+2^32 values.
+*/
+
+/// (a + b) / 2, rounded towards zero like integer division, without overflow.
+template <typename T>
+constexpr T midpoint(T a, T b)
+{
+	static_assert(std::is_integral_v<T>);
+	const T floor = static_cast<T>((a & b) + ((a ^ b) >> 1));
+	if constexpr (std::is_signed_v<T>)
+	{
+		// Arithmetic shift rounds down. For a negative odd sum round up instead.
+		return static_cast<T>(floor + ((a ^ b) & 1 & (floor < 0)));
+	}
+	else
+	{
+		return floor;
+	}
+}
+
+/// result[i] = midpoint(a[i], b[i]).
+template <typename T>
+void midpoints(std::span<const T> a, std::span<const T> b, std::span<T> result)
+{
+	assert(a.size() == b.size() && a.size() == result.size());
+	for (std::size_t i = 0; i < result.size(); ++i)
+	{
+		result[i] = midpoint(a[i], b[i]);
+	}
+}
+
+/// The exact sum of 'values'.
+template <typename T>
+auto exactSum(std::span<const T> values)
+{
+	static_assert(std::is_same_v<T, std::int64_t> || std::is_same_v<T, std::uint64_t>);
+	using Wide = std::conditional_t<std::is_signed_v<T>, __int128, unsigned __int128>;
+
+	// Signed values are offset by 2^63 into the unsigned range, which flips
+	// the sign bit, and the offset is subtracted again at the end. Everything
+	// in the loop is then unsigned, and only logical shifts are needed. SSE2
+	// and AVX2 have no 64-bit arithmetic shift.
+	constexpr std::uint64_t OFFSET {std::is_signed_v<T> ? std::uint64_t {1} << 63 : 0};
+	constexpr std::size_t BLOCK_SIZE {std::size_t {1} << 32};
+	Wide sum {0};
+	for (std::size_t block = 0; block < values.size(); block += BLOCK_SIZE)
+	{
+		const std::span<const T> part =
+			values.subspan(block).first(std::min(BLOCK_SIZE, values.size() - block));
+		std::uint64_t wrapped {0};
+		std::uint64_t high {0};
+		for (T value : part)
+		{
+			const std::uint64_t bits = static_cast<std::uint64_t>(value) ^ OFFSET;
+			wrapped += bits;
+			high += bits >> 32;
+		}
+		// The sum of the low halves is less than 2^64, and the wrapped sum is
+		// the full sum modulo 2^64, so it follows from the other two.
+		const std::uint64_t low = wrapped - (high << 32);
+		sum += (static_cast<Wide>(high) << 32) + static_cast<Wide>(low);
+		sum -= static_cast<Wide>(part.size()) * OFFSET;
+	}
+	return sum;
+}
+
+/// The average of 'values', computed from the exact sum.
+template <typename T>
+double average(std::span<const T> values)
+{
+	assert(!values.empty());
+	// Split into quotient and remainder first. Converting the sum itself to
+	// double would lose the low bits of a sum larger than 2^53.
+	const auto sum = exactSum(values);
+	const auto count = static_cast<std::ptrdiff_t>(values.size());
+	return static_cast<double>(static_cast<T>(sum / count)) +
+		static_cast<double>(static_cast<T>(sum % count)) / static_cast<double>(count);
+}
+
+/// The average of 'values' rounded towards zero, always representable in T.
+template <typename T>
+T integerAverage(std::span<const T> values)
+{
+	assert(!values.empty());
+	return static_cast<T>(exactSum(values) / static_cast<std::ptrdiff_t>(values.size()));
+}
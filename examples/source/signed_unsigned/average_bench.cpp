@@ -0,0 +1,156 @@
+/*
+The overflow-free midpoint and average from average.h against the
+overflowing versions, 'add_and_divide_by_two' from signed_unsigned.cpp and
+'average' from from_compiler_explorer.cpp, and against a plain __int128
+accumulator.
+
+- AverageInt64: sum into an int64_t, overflows for large values.
+- AverageInt128: sum into an __int128, exact but doesn't vectorize.
+- AverageExact: 'average' from average.h, exact and vectorized.
+- MidpointsAddDivide: (a + b) / 2 per element, overflows for large values.
+- MidpointsExact: 'midpoints' from average.h.
+
+The goal is for the exact versions to run at the speed of the overflowing
+ones, limited by memory bandwidth for the large buffers.
+
+Build in Release mode, the kernels are meaningless without optimization:
+  cmake -S . -B build -DCMAKE_BUILD_TYPE=Release
+  cmake --build build --target average_bench
+*/
+
+#include "average.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <vector>
+
+// Same sizes as sum_loop_bench.cpp.
+constexpr std::int64_t MIN_SIZE {128};
+constexpr std::int64_t MAX_SIZE {std::int64_t {64} << 20};
+constexpr int SIZE_MULTIPLIER {8};
+
+std::vector<std::int64_t> getBuffer(std::int64_t size)
+{
+	std::vector<std::int64_t> buffer(static_cast<std::size_t>(size));
+	std::iota(buffer.begin(), buffer.end(), std::int64_t {1});
+	return buffer;
+}
+
+/*
+Average
+*/
+
+__attribute((noinline)) double averageInt64(std::span<const std::int64_t> values)
+{
+	std::int64_t sum {0};
+	for (std::int64_t value : values)
+	{
+		sum += value;
+	}
+	return static_cast<double>(sum) / static_cast<double>(values.size());
+}
+
+__attribute((noinline)) double averageInt128(std::span<const std::int64_t> values)
+{
+	__int128 sum {0};
+	for (std::int64_t value : values)
+	{
+		sum += value;
+	}
+	return static_cast<double>(sum) / static_cast<double>(values.size());
+}
+
+__attribute((noinline)) double averageExact(std::span<const std::int64_t> values)
+{
+	return average(values);
+}
+
+template <typename Average>
+static void averageBenchmark(benchmark::State& state, Average average)
+{
+	const std::vector<std::int64_t> buffer = getBuffer(state.range(0));
+	for (auto _ : state)
+	{
+		double a = average(buffer);
+		benchmark::DoNotOptimize(a);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	state.SetBytesProcessed(state.iterations() * state.range(0) * 8);
+}
+
+static void AverageInt64(benchmark::State& state)
+{
+	averageBenchmark(state, averageInt64);
+}
+
+static void AverageInt128(benchmark::State& state)
+{
+	averageBenchmark(state, averageInt128);
+}
+
+static void AverageExact(benchmark::State& state)
+{
+	averageBenchmark(state, averageExact);
+}
+
+/*
+Midpoints
+*/
+
+__attribute((noinline)) void midpointsAddDivide(
+	std::span<const std::int64_t> a, std::span<const std::int64_t> b,
+	std::span<std::int64_t> result)
+{
+	for (std::size_t i = 0; i < result.size(); ++i)
+	{
+		result[i] = (a[i] + b[i]) / 2;
+	}
+}
+
+__attribute((noinline)) void midpointsExact(
+	std::span<const std::int64_t> a, std::span<const std::int64_t> b,
+	std::span<std::int64_t> result)
+{
+	midpoints(a, b, result);
+}
+
+template <typename Midpoints>
+static void midpointsBenchmark(benchmark::State& state, Midpoints midpoints)
+{
+	const std::vector<std::int64_t> a = getBuffer(state.range(0));
+	const std::vector<std::int64_t> b = getBuffer(state.range(0));
+	std::vector<std::int64_t> result(a.size());
+	for (auto _ : state)
+	{
+		midpoints(a, b, result);
+		benchmark::DoNotOptimize(result.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	state.SetBytesProcessed(state.iterations() * state.range(0) * 3 * 8);
+}
+
+static void MidpointsAddDivide(benchmark::State& state)
+{
+	midpointsBenchmark(state, midpointsAddDivide);
+}
+
+static void MidpointsExact(benchmark::State& state)
+{
+	midpointsBenchmark(state, midpointsExact);
+}
+
+// clang-format off
+BENCHMARK(AverageInt64)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(AverageInt128)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(AverageExact)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+
+BENCHMARK(MidpointsAddDivide)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(MidpointsExact)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+// clang-format on
+
+BENCHMARK_MAIN();
@@ -0,0 +1,360 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+
+/*
+Integer types with a chosen behavior on overflow.
+
+The examples in from_compiler_explorer.cpp and signed_unsigned.cpp show the
+ways integer arithmetic goes wrong: unsigned arithmetic silently wraps,
+signed overflow is undefined behavior, and narrowing conversions truncate.
+The fix in 'safe_add' is hand-written for one operation and one type. These
+wrappers make the choice once, in the type:
+
+- Checked<T> computes the wrapped result and remembers that an overflow
+  happened. The flag is sticky, it carries through every later operation, so
+  a whole computation can be checked once at the end.
+- Saturating<T> clamps to the smallest or largest value of T.
+- Wrapping<T> wraps around, also for signed T, where plain arithmetic would be
+  undefined behavior.
+
+The operators use __builtin_add_overflow and friends, which compile to the
+operation followed by a check of the CPU's overflow or carry flag, so the
+non-overflow path costs a flag test that is practically always predicted
+correctly.
+
+Those builtins don't vectorize, GCC won't turn a loop of them into SIMD
+instructions. The batch functions at the bottom therefore detect overflow
+with plain bit operations on the wrapped result instead, which the compiler
+vectorizes like any other elementwise loop, and OR the overflow bits of all
+elements together so that there is no branch inside the loop.
+*/
+
+namespace overflow
+{
+	template <std::integral T>
+	class Checked
+	{
+	public:
+		constexpr Checked() = default;
+
+		constexpr Checked(T value)
+			: m_value(value)
+		{
+		}
+
+		constexpr Checked(T value, bool overflow)
+			: m_value(value)
+			, m_overflow(overflow)
+		{
+		}
+
+		/// The result of the operations, wrapped if any of them overflowed.
+		constexpr T value() const
+		{
+			return m_value;
+		}
+
+		constexpr bool overflowed() const
+		{
+			return m_overflow;
+		}
+
+		/// The value, or std::overflow_error if any operation overflowed.
+		T get() const
+		{
+			if (m_overflow)
+			{
+				throw std::overflow_error("Checked: integer overflow.");
+			}
+			return m_value;
+		}
+
+		friend constexpr Checked operator+(Checked lhs, Checked rhs)
+		{
+			Checked result;
+			result.m_overflow = __builtin_add_overflow(lhs.m_value, rhs.m_value, &result.m_value);
+			result.m_overflow |= lhs.m_overflow || rhs.m_overflow;
+			return result;
+		}
+
+		friend constexpr Checked operator-(Checked lhs, Checked rhs)
+		{
+			Checked result;
+			result.m_overflow = __builtin_sub_overflow(lhs.m_value, rhs.m_value, &result.m_value);
+			result.m_overflow |= lhs.m_overflow || rhs.m_overflow;
+			return result;
+		}
+
+		friend constexpr Checked operator*(Checked lhs, Checked rhs)
+		{
+			Checked result;
+			result.m_overflow = __builtin_mul_overflow(lhs.m_value, rhs.m_value, &result.m_value);
+			result.m_overflow |= lhs.m_overflow || rhs.m_overflow;
+			return result;
+		}
+
+		constexpr Checked& operator+=(Checked rhs)
+		{
+			return *this = *this + rhs;
+		}
+
+		constexpr Checked& operator-=(Checked rhs)
+		{
+			return *this = *this - rhs;
+		}
+
+		constexpr Checked& operator*=(Checked rhs)
+		{
+			return *this = *this * rhs;
+		}
+
+	private:
+		T m_value {0};
+		bool m_overflow {false};
+	};
+
+	template <std::integral T>
+	class Saturating
+	{
+	public:
+		constexpr Saturating() = default;
+
+		constexpr Saturating(T value)
+			: m_value(value)
+		{
+		}
+
+		constexpr T value() const
+		{
+			return m_value;
+		}
+
+		friend constexpr Saturating operator+(Saturating lhs, Saturating rhs)
+		{
+			T result;
+			if (__builtin_add_overflow(lhs.m_value, rhs.m_value, &result))
+			{
+				// Signed overflow is in the direction of rhs' sign, unsigned only up.
+				return rhs.m_value < 0 ? MIN : MAX;
+			}
+			return result;
+		}
+
+		friend constexpr Saturating operator-(Saturating lhs, Saturating rhs)
+		{
+			T result;
+			if (__builtin_sub_overflow(lhs.m_value, rhs.m_value, &result))
+			{
+				// For unsigned types rhs > lhs, the true result is negative.
+				return rhs.m_value > 0 ? MIN : MAX;
+			}
+			return result;
+		}
+
+		friend constexpr Saturating operator*(Saturating lhs, Saturating rhs)
+		{
+			T result;
+			if (__builtin_mul_overflow(lhs.m_value, rhs.m_value, &result))
+			{
+				return (lhs.m_value < 0) != (rhs.m_value < 0) ? MIN : MAX;
+			}
+			return result;
+		}
+
+		constexpr Saturating& operator+=(Saturating rhs)
+		{
+			return *this = *this + rhs;
+		}
+
+		constexpr Saturating& operator-=(Saturating rhs)
+		{
+			return *this = *this - rhs;
+		}
+
+		constexpr Saturating& operator*=(Saturating rhs)
+		{
+			return *this = *this * rhs;
+		}
+
+	private:
+		static constexpr T MIN {std::numeric_limits<T>::min()};
+		static constexpr T MAX {std::numeric_limits<T>::max()};
+
+		T m_value {0};
+	};
+
+	template <std::integral T>
+	class Wrapping
+	{
+	public:
+		constexpr Wrapping() = default;
+
+		constexpr Wrapping(T value)
+			: m_value(value)
+		{
+		}
+
+		constexpr T value() const
+		{
+			return m_value;
+		}
+
+		// The builtins store the wrapped result whether or not they overflow.
+
+		friend constexpr Wrapping operator+(Wrapping lhs, Wrapping rhs)
+		{
+			T result;
+			__builtin_add_overflow(lhs.m_value, rhs.m_value, &result);
+			return result;
+		}
+
+		friend constexpr Wrapping operator-(Wrapping lhs, Wrapping rhs)
+		{
+			T result;
+			__builtin_sub_overflow(lhs.m_value, rhs.m_value, &result);
+			return result;
+		}
+
+		friend constexpr Wrapping operator*(Wrapping lhs, Wrapping rhs)
+		{
+			T result;
+			__builtin_mul_overflow(lhs.m_value, rhs.m_value, &result);
+			return result;
+		}
+
+		constexpr Wrapping& operator+=(Wrapping rhs)
+		{
+			return *this = *this + rhs;
+		}
+
+		constexpr Wrapping& operator-=(Wrapping rhs)
+		{
+			return *this = *this - rhs;
+		}
+
+		constexpr Wrapping& operator*=(Wrapping rhs)
+		{
+			return *this = *this * rhs;
+		}
+
+	private:
+		T m_value {0};
+	};
+
+	/// 'value' converted to To, flagged as overflowed if it doesn't fit, e.g.
+	/// the truncation in 'add_trunc_32' in from_compiler_explorer.cpp. From may
+	/// also be __int128, which isn't std::integral in strict C++20 mode.
+	template <std::integral To, typename From>
+	constexpr Checked<To> checkedCast(From value)
+	{
+		To result;
+		const bool overflow = __builtin_add_overflow(value, From {0}, &result);
+		return Checked<To>(result, overflow);
+	}
+
+	/// result[i] = lhs[i] + rhs[i], wrapped on overflow. Returns true if any of
+	/// the additions overflowed.
+	template <std::integral T>
+	bool addChecked(std::span<const T> lhs, std::span<const T> rhs, std::span<T> result)
+	{
+		assert(lhs.size() == rhs.size() && lhs.size() == result.size());
+		using U = std::make_unsigned_t<T>;
+		constexpr int SIGN_BIT {std::numeric_limits<U>::digits - 1};
+
+		U overflow {0};
+		for (std::size_t i = 0; i < result.size(); ++i)
+		{
+			const U a = static_cast<U>(lhs[i]);
+			const U b = static_cast<U>(rhs[i]);
+			const U sum = static_cast<U>(a + b);
+			if constexpr (std::is_signed_v<T>)
+			{
+				// Overflow if both operands have a sign different from the sum's.
+				overflow |= static_cast<U>(((a ^ sum) & (b ^ sum)) >> SIGN_BIT);
+			}
+			else
+			{
+				overflow |= static_cast<U>(sum < a);
+			}
+			result[i] = static_cast<T>(sum);
+		}
+		return overflow != 0;
+	}
+
+	/// result[i] = lhs[i] + rhs[i], clamped to the range of T.
+	template <std::integral T>
+	void addSaturating(std::span<const T> lhs, std::span<const T> rhs, std::span<T> result)
+	{
+		assert(lhs.size() == rhs.size() && lhs.size() == result.size());
+		using U = std::make_unsigned_t<T>;
+		constexpr int SIGN_BIT {std::numeric_limits<U>::digits - 1};
+
+		for (std::size_t i = 0; i < result.size(); ++i)
+		{
+			const U a = static_cast<U>(lhs[i]);
+			const U b = static_cast<U>(rhs[i]);
+			const U sum = static_cast<U>(a + b);
+			if constexpr (std::is_signed_v<T>)
+			{
+				// On overflow both operands have the same sign. Negative
+				// saturates to MIN, 0x80..., positive to MAX, 0x7F....
+				const bool overflow = (((a ^ sum) & (b ^ sum)) >> SIGN_BIT) != 0;
+				const U limit = static_cast<U>((a >> SIGN_BIT) + std::numeric_limits<T>::max());
+				result[i] = static_cast<T>(overflow ? limit : sum);
+			}
+			else
+			{
+				result[i] = static_cast<T>(sum < a ? std::numeric_limits<T>::max() : sum);
+			}
+		}
+	}
+
+	/// Sum of 'values'. Overflowed only if the exact sum doesn't fit in T,
+	/// partial sums along the way may go out of range and come back.
+	template <std::integral T>
+	Checked<T> sumChecked(std::span<const T> values)
+	{
+		if constexpr (sizeof(T) <= 4)
+		{
+			// A 64-bit sum of 2^31 32-bit values can't overflow, and that loop
+			// vectorizes. Longer spans are summed in blocks of that size.
+			using Wide = std::conditional_t<std::is_signed_v<T>, std::int64_t, std::uint64_t>;
+			constexpr std::size_t BLOCK_SIZE {std::size_t {1} << 31};
+			Checked<Wide> total;
+			for (std::size_t block = 0; block < values.size(); block += BLOCK_SIZE)
+			{
+				Wide sum {0};
+				const std::span<const T> part = values.subspan(block).first(
+					std::min(BLOCK_SIZE, values.size() - block));
+				for (T value : part)
+				{
+					sum += value;
+				}
+				total += sum;
+			}
+			const Checked<T> result = checkedCast<T>(total.value());
+			return Checked<T>(result.value(), result.overflowed() || total.overflowed());
+		}
+		else
+		{
+			// No wider integer type that vectorizes, 128-bit adds are an add
+			// and an add-with-carry per element.
+			using Wide = std::conditional_t<std::is_signed_v<T>, __int128, unsigned __int128>;
+			Wide sum {0};
+			for (T value : values)
+			{
+				sum += value;
+			}
+			return checkedCast<T>(sum);
+		}
+	}
+}
@@ -0,0 +1,212 @@
+#pragma once
+
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <span>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+/*
+Load data[base_index + byte_offset / element_size] for many byte offsets.
+
+This is 'byte_offset' from from_compiler_explorer.cpp turned into something
+that does the loads. Done one at a time, every element costs a 64-bit
+division, 20 to 90 cycles depending on the CPU, and a load from an address
+that is only known once the division is done. For a sparse lookup into a
+large array most of those loads are cache misses, and the CPU can only
+overlap as many of them as it can see ahead.
+
+ElementSize precomputes how to divide. Element sizes are almost always a
+power of two, and then the division is a shift. A plain arithmetic shift
+rounds towards minus infinity while division rounds towards zero, so negative
+offsets are biased by element_size - 1 first, which is what the compiler does
+for a division by a constant power of two. Non-power-of-two sizes keep the
+division.
+
+With a power-of-two size there are two ways to do the loads:
+
+- gatherAvx2 computes four indices at a time in AVX2 registers and loads the
+  four elements with a single vgatherqpd. AVX2 has no 64-bit arithmetic
+  shift, so it is done as a logical shift with the sign bits ORed back in.
+  The function is compiled for AVX2 with a target attribute, so that the rest
+  of the program doesn't need -mavx2, and 'gather' only calls it if the CPU
+  supports AVX2.
+- gatherPrefetch does one element at a time, and prefetches the element
+  PREFETCH_DISTANCE offsets ahead. By the time the loop gets there the cache
+  miss is, ideally, already done. This works for any element size and any
+  CPU, and is what 'gather' falls back to.
+
+The offsets must all point inside 'data'. That is asserted in gatherPrefetch
+but not checked in gatherAvx2.
+*/
+
+/// An element size, with the division by it precomputed.
+class ElementSize
+{
+public:
+	explicit ElementSize(std::ptrdiff_t size)
+		: m_size(size)
+		, m_shift(std::has_single_bit(static_cast<std::size_t>(size))
+					  ? std::countr_zero(static_cast<std::size_t>(size))
+					  : -1)
+	{
+		assert(size > 0);
+	}
+
+	std::ptrdiff_t size() const
+	{
+		return m_size;
+	}
+
+	bool isPowerOfTwo() const
+	{
+		return m_shift >= 0;
+	}
+
+	/// log2(size), only for power-of-two sizes.
+	int shift() const
+	{
+		assert(isPowerOfTwo());
+		return m_shift;
+	}
+
+	/// byte_offset / size, rounded towards zero just like the division.
+	std::ptrdiff_t divide(std::ptrdiff_t byte_offset) const
+	{
+		if (isPowerOfTwo())
+		{
+			const std::ptrdiff_t bias = (byte_offset >> 63) & (m_size - 1);
+			return (byte_offset + bias) >> m_shift;
+		}
+		return byte_offset / m_size;
+	}
+
+private:
+	std::ptrdiff_t m_size;
+	int m_shift;
+};
+
+/// indices[i] = base_index + byte_offsets[i] / element_size.
+inline void computeIndices(
+	std::ptrdiff_t base_index, std::span<const std::ptrdiff_t> byte_offsets,
+	ElementSize element_size, std::span<std::ptrdiff_t> indices)
+{
+	assert(byte_offsets.size() == indices.size());
+	// Separate loops so that the power-of-two one has no division in it and
+	// can be vectorized.
+	if (element_size.isPowerOfTwo())
+	{
+		const std::ptrdiff_t mask = element_size.size() - 1;
+		const int shift = element_size.shift();
+		for (std::size_t i = 0; i < indices.size(); ++i)
+		{
+			const std::ptrdiff_t offset = byte_offsets[i];
+			indices[i] = base_index + ((offset + ((offset >> 63) & mask)) >> shift);
+		}
+	}
+	else
+	{
+		for (std::size_t i = 0; i < indices.size(); ++i)
+		{
+			indices[i] = base_index + byte_offsets[i] / element_size.size();
+		}
+	}
+}
+
+/// values[i] = data[base_index + byte_offsets[i] / element_size], one at a
+/// time with software prefetching. Any element size.
+inline void gatherPrefetch(
+	std::span<const double> data, std::ptrdiff_t base_index,
+	std::span<const std::ptrdiff_t> byte_offsets, ElementSize element_size,
+	std::span<double> values)
+{
+	assert(byte_offsets.size() == values.size());
+	constexpr std::size_t PREFETCH_DISTANCE {16};
+	const std::size_t count = values.size();
+	for (std::size_t i = 0; i < count; ++i)
+	{
+		if (i + PREFETCH_DISTANCE < count)
+		{
+			// A prefetch never faults, even for an address outside 'data'.
+			const std::ptrdiff_t ahead =
+				base_index + element_size.divide(byte_offsets[i + PREFETCH_DISTANCE]);
+			__builtin_prefetch(data.data() + ahead);
+		}
+		const std::ptrdiff_t index = base_index + element_size.divide(byte_offsets[i]);
+		assert(index >= 0 && index < std::ssize(data));
+		values[i] = data[static_cast<std::size_t>(index)];
+	}
+}
+
+#if defined(__x86_64__)
+/// Same as gatherPrefetch with AVX2 hardware gathers, four elements at a
+/// time. Only for power-of-two element sizes, and only call it if
+/// hasAvx2Gather() is true.
+__attribute((target("avx2"))) inline void gatherAvx2(
+	std::span<const double> data, std::ptrdiff_t base_index,
+	std::span<const std::ptrdiff_t> byte_offsets, ElementSize element_size,
+	std::span<double> values)
+{
+	assert(byte_offsets.size() == values.size());
+	const int shift = element_size.shift();
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i bias = _mm256_set1_epi64x(element_size.size() - 1);
+	const __m256i base = _mm256_set1_epi64x(base_index);
+	const __m128i shift_right = _mm_cvtsi32_si128(shift);
+	// Shifting by 64 or more gives zero, which is right for shift == 0.
+	const __m128i shift_left = _mm_cvtsi32_si128(64 - shift);
+
+	const std::size_t count = values.size();
+	std::size_t i {0};
+	for (; i + 4 <= count; i += 4)
+	{
+		const __m256i offsets =
+			_mm256_loadu_si256(reinterpret_cast<const __m256i*>(byte_offsets.data() + i));
+		const __m256i biased = _mm256_add_epi64(
+			offsets, _mm256_and_si256(_mm256_cmpgt_epi64(zero, offsets), bias));
+		// Arithmetic shift right: logical shift, then fill the vacated high
+		// bits with ones for negative values.
+		const __m256i negative = _mm256_cmpgt_epi64(zero, biased);
+		const __m256i quotients = _mm256_or_si256(
+			_mm256_srl_epi64(biased, shift_right), _mm256_sll_epi64(negative, shift_left));
+		const __m256i indices = _mm256_add_epi64(base, quotients);
+		_mm256_storeu_pd(values.data() + i, _mm256_i64gather_pd(data.data(), indices, 8));
+	}
+	for (; i < count; ++i)
+	{
+		const std::ptrdiff_t index = base_index + element_size.divide(byte_offsets[i]);
+		values[i] = data[static_cast<std::size_t>(index)];
+	}
+}
+
+inline bool hasAvx2Gather()
+{
+	static const bool has_avx2 = __builtin_cpu_supports("avx2");
+	return has_avx2;
+}
+#else
+inline bool hasAvx2Gather()
+{
+	return false;
+}
+#endif
+
+/// values[i] = data[base_index + byte_offsets[i] / element_size], with the
+/// fastest method available for this element size and CPU.
+inline void gather(
+	std::span<const double> data, std::ptrdiff_t base_index,
+	std::span<const std::ptrdiff_t> byte_offsets, ElementSize element_size,
+	std::span<double> values)
+{
+#if defined(__x86_64__)
+	if (element_size.isPowerOfTwo() && hasAvx2Gather())
+	{
+		gatherAvx2(data, base_index, byte_offsets, element_size, values);
+		return;
+	}
+#endif
+	gatherPrefetch(data, base_index, byte_offsets, element_size, values);
+}
@@ -0,0 +1,161 @@
+/*
+Sparse lookups data[base_index + byte_offset / element_size] with random
+offsets, the pattern of 'byte_offset' in from_compiler_explorer.cpp, using
+gather.h.
+
+- GatherDivide: the original loop, a division per offset.
+- GatherShift: computeIndices, a shift instead of the division, then the loads.
+- GatherPrefetch: gatherPrefetch, shift and software prefetching.
+- GatherAvx2: gatherAvx2, four indices at a time and vgatherqpd. Skipped on
+  CPUs without AVX2.
+
+The number of lookups is fixed, the size of 'data' varies. Once it no longer
+fits in the caches every lookup is a cache miss, and the difference is in how
+many of the misses each variant keeps in flight.
+
+Build in Release mode, the kernels are meaningless without optimization:
+  cmake -S . -B build -DCMAKE_BUILD_TYPE=Release
+  cmake --build build --target gather_bench
+*/
+
+#include "gather.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <span>
+#include <vector>
+
+// Same sizes as sum_loop_bench.cpp.
+constexpr std::int64_t MIN_SIZE {128};
+constexpr std::int64_t MAX_SIZE {std::int64_t {64} << 20};
+constexpr int SIZE_MULTIPLIER {8};
+
+constexpr std::ptrdiff_t NUM_LOOKUPS {1 << 16};
+constexpr std::ptrdiff_t ELEMENT_SIZE {sizeof(double)};
+
+struct Lookups
+{
+	std::vector<double> data;
+	std::ptrdiff_t base_index;
+	std::vector<std::ptrdiff_t> byte_offsets;
+};
+
+/// Random byte offsets, positive and negative, around the middle of 'data'.
+Lookups getLookups(std::int64_t size)
+{
+	Lookups lookups;
+	lookups.data.resize(static_cast<std::size_t>(size));
+	std::iota(lookups.data.begin(), lookups.data.end(), 0.0);
+	lookups.base_index = size / 2;
+
+	std::mt19937_64 generator(42);
+	std::uniform_int_distribution<std::ptrdiff_t> distribution(
+		-lookups.base_index, size - lookups.base_index - 1);
+	lookups.byte_offsets.resize(NUM_LOOKUPS);
+	for (std::ptrdiff_t& offset : lookups.byte_offsets)
+	{
+		offset = distribution(generator) * ELEMENT_SIZE;
+	}
+	return lookups;
+}
+
+__attribute((noinline)) void gatherDivide(
+	std::span<const double> data, std::ptrdiff_t base_index,
+	std::span<const std::ptrdiff_t> byte_offsets, std::ptrdiff_t element_size,
+	std::span<double> values)
+{
+	for (std::size_t i = 0; i < values.size(); ++i)
+	{
+		const std::ptrdiff_t index = base_index + byte_offsets[i] / element_size;
+		values[i] = data[static_cast<std::size_t>(index)];
+	}
+}
+
+__attribute((noinline)) void gatherShift(
+	std::span<const double> data, std::ptrdiff_t base_index,
+	std::span<const std::ptrdiff_t> byte_offsets, ElementSize element_size,
+	std::span<std::ptrdiff_t> indices, std::span<double> values)
+{
+	computeIndices(base_index, byte_offsets, element_size, indices);
+	for (std::size_t i = 0; i < values.size(); ++i)
+	{
+		values[i] = data[static_cast<std::size_t>(indices[i])];
+	}
+}
+
+static void GatherDivide(benchmark::State& state)
+{
+	const Lookups lookups = getLookups(state.range(0));
+	std::vector<double> values(lookups.byte_offsets.size());
+	// Opaque to the compiler, so that it can't replace the division by a shift.
+	std::ptrdiff_t element_size {ELEMENT_SIZE};
+	benchmark::DoNotOptimize(element_size);
+	for (auto _ : state)
+	{
+		gatherDivide(lookups.data, lookups.base_index, lookups.byte_offsets, element_size, values);
+		benchmark::DoNotOptimize(values.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * NUM_LOOKUPS);
+}
+
+static void GatherShift(benchmark::State& state)
+{
+	const Lookups lookups = getLookups(state.range(0));
+	std::vector<std::ptrdiff_t> indices(lookups.byte_offsets.size());
+	std::vector<double> values(lookups.byte_offsets.size());
+	const ElementSize element_size(ELEMENT_SIZE);
+	for (auto _ : state)
+	{
+		gatherShift(
+			lookups.data, lookups.base_index, lookups.byte_offsets, element_size, indices, values);
+		benchmark::DoNotOptimize(values.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * NUM_LOOKUPS);
+}
+
+template <typename Gather>
+static void gatherBenchmark(benchmark::State& state, Gather gather)
+{
+	const Lookups lookups = getLookups(state.range(0));
+	std::vector<double> values(lookups.byte_offsets.size());
+	const ElementSize element_size(ELEMENT_SIZE);
+	for (auto _ : state)
+	{
+		gather(lookups.data, lookups.base_index, lookups.byte_offsets, element_size, values);
+		benchmark::DoNotOptimize(values.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * NUM_LOOKUPS);
+}
+
+static void GatherPrefetch(benchmark::State& state)
+{
+	gatherBenchmark(state, gatherPrefetch);
+}
+
+static void GatherAvx2(benchmark::State& state)
+{
+#if defined(__x86_64__)
+	if (hasAvx2Gather())
+	{
+		gatherBenchmark(state, gatherAvx2);
+		return;
+	}
+#endif
+	state.SkipWithError("AVX2 not supported.");
+}
+
+// clang-format off
+BENCHMARK(GatherDivide)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(GatherShift)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(GatherPrefetch)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(GatherAvx2)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+// clang-format on
+
+BENCHMARK_MAIN();
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cassert>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+/*
+Ranges of indices with a stride, for reverse and strided loops without
+hand-written loop conditions.
+
+'reverse_loop_template' in from_compiler_explorer.cpp shows how awkward a
+reverse loop is. With an unsigned index the loop must rely on the index
+wrapping around to a huge value after zero, 'index < size', and with a
+signed index the condition is different, 'index >= 0'. The signed
+'continueReverseLoop' there even gets it wrong, 'index > 0' skips the first
+element. Strided loops add the question of whether the last index is reached
+exactly or overshot.
+
+A StridedRange is 'count' indices starting at 'begin', 'stride' apart, where
+the stride may be negative. The loop itself always counts a position from 0
+up to 'count', and the index is begin + position * stride. That is the
+canonical loop shape compilers recognize: the trip count is known before the
+loop starts and the index is a plain induction variable, so the loop is
+vectorized like a forward one. For a stride of -1 that is a vector load and a
+shuffle reversing the lanes. No comparison against the end index is needed,
+so nothing can be overshot, and all arithmetic is signed, so nothing wraps.
+
+The iterator is three integers and every operation on it is inlined, after
+which no trace of it remains in the generated code. reverse_bench.cpp
+compares it against the hand-written loops.
+
+The indices are signed, even for a container with an unsigned size_type.
+They convert implicitly when passed to operator[].
+*/
+
+template <std::signed_integral IndexT = std::ptrdiff_t>
+class StridedRange
+{
+public:
+	class iterator
+	{
+	public:
+		using iterator_concept = std::forward_iterator_tag;
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = IndexT;
+		using difference_type = IndexT;
+
+		iterator() = default;
+
+		iterator(IndexT begin, IndexT stride, IndexT position)
+			: m_begin(begin)
+			, m_stride(stride)
+			, m_position(position)
+		{
+		}
+
+		IndexT operator*() const
+		{
+			return m_begin + m_position * m_stride;
+		}
+
+		iterator& operator++()
+		{
+			++m_position;
+			return *this;
+		}
+
+		iterator operator++(int)
+		{
+			iterator previous = *this;
+			++m_position;
+			return previous;
+		}
+
+		/// Only iterators of the same range may be compared.
+		friend bool operator==(const iterator& lhs, const iterator& rhs)
+		{
+			return lhs.m_position == rhs.m_position;
+		}
+
+	private:
+		IndexT m_begin {0};
+		IndexT m_stride {0};
+		IndexT m_position {0};
+	};
+
+	StridedRange(IndexT begin, IndexT count, IndexT stride)
+		: m_begin(begin)
+		, m_count(count)
+		, m_stride(stride)
+	{
+		assert(count >= 0);
+		// The last index must be representable, (count - 1) * stride must not
+		// overflow.
+		assert([&] {
+			IndexT last;
+			return count == 0 ||
+				(!__builtin_mul_overflow(count - 1, stride, &last) &&
+				 !__builtin_add_overflow(begin, last, &last));
+		}());
+	}
+
+	iterator begin() const
+	{
+		return iterator(m_begin, m_stride, 0);
+	}
+
+	iterator end() const
+	{
+		return iterator(m_begin, m_stride, m_count);
+	}
+
+	IndexT size() const
+	{
+		return m_count;
+	}
+
+	bool empty() const
+	{
+		return m_count == 0;
+	}
+
+	/// The index at 'position', 0 <= position < size().
+	IndexT operator[](IndexT position) const
+	{
+		assert(position >= 0 && position < m_count);
+		return m_begin + position * m_stride;
+	}
+
+	IndexT stride() const
+	{
+		return m_stride;
+	}
+
+private:
+	IndexT m_begin;
+	IndexT m_count;
+	IndexT m_stride;
+};
+
+/// 'count' indices begin, begin + stride, begin + 2 * stride, ... The stride
+/// may be negative or zero.
+template <std::signed_integral IndexT>
+StridedRange<IndexT> strided_range(
+	IndexT begin, std::type_identity_t<IndexT> count, std::type_identity_t<IndexT> stride)
+{
+	return StridedRange<IndexT>(begin, count, stride);
+}
+
+/// The indices of 'container' from size() - 1 down to 0, signed.
+template <typename Container>
+auto reverse_indices(const Container& container)
+{
+	using IndexT = std::make_signed_t<decltype(container.size())>;
+	const auto size = static_cast<IndexT>(container.size());
+	return StridedRange<IndexT>(size - 1, size, -1);
+}
@@ -0,0 +1,230 @@
+/*
+The cost of overflow checking, with the types and batch functions from
+checked_arithmetic.h, against the same loops without any checking.
+
+- ArithmeticSeries: 1 + 2 + ... + n as in 'arithmetic_series' in
+  signed_unsigned.cpp, with a uint64_t, a Checked<uint64_t>, and a
+  Saturating<uint64_t> accumulator. n is hidden from the compiler so that the
+  plain loop isn't replaced by the closed form.
+- AddArrays: elementwise int32_t addition of two arrays. Plain wraps (through
+  unsigned arithmetic, to avoid undefined behavior), Checked and Saturating
+  are addChecked and addSaturating, and BuiltinLoop is a loop calling
+  __builtin_add_overflow per element, which doesn't vectorize.
+- Sum: sum of an int32_t array, plain into an int32_t (wrapping) and
+  sumChecked.
+
+Build in Release mode, the comparison is meaningless without optimization:
+  cmake -S . -B build -DCMAKE_BUILD_TYPE=Release
+  cmake --build build --target overflow_bench
+
+Run a subset, e.g. only the array additions:
+  ./build/signed_unsigned/overflow_bench --benchmark_filter=AddArrays
+*/
+
+#include "checked_arithmetic.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <span>
+#include <vector>
+
+// Same sizes as sum_loop_bench.cpp.
+constexpr std::int64_t MIN_SIZE {128};
+constexpr std::int64_t MAX_SIZE {std::int64_t {64} << 20};
+constexpr int SIZE_MULTIPLIER {8};
+
+template <typename T>
+std::vector<T> getBuffer(std::int64_t size)
+{
+	std::vector<T> buffer(static_cast<std::size_t>(size));
+	std::iota(buffer.begin(), buffer.end(), T {1});
+	return buffer;
+}
+
+/*
+ArithmeticSeries
+*/
+
+template <typename Accumulator>
+__attribute((noinline)) std::uint64_t arithmetic_series(std::uint64_t n)
+{
+	Accumulator sum {0};
+	for (std::uint64_t i = 1; i <= n; ++i)
+	{
+		sum += i;
+	}
+	if constexpr (std::is_same_v<Accumulator, std::uint64_t>)
+	{
+		return sum;
+	}
+	else
+	{
+		return sum.value();
+	}
+}
+
+template <typename Accumulator>
+static void arithmeticSeriesBenchmark(benchmark::State& state)
+{
+	std::uint64_t n {static_cast<std::uint64_t>(state.range(0))};
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(n);
+		std::uint64_t s = arithmetic_series<Accumulator>(n);
+		benchmark::DoNotOptimize(s);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void ArithmeticSeriesPlain(benchmark::State& state)
+{
+	arithmeticSeriesBenchmark<std::uint64_t>(state);
+}
+
+static void ArithmeticSeriesChecked(benchmark::State& state)
+{
+	arithmeticSeriesBenchmark<overflow::Checked<std::uint64_t>>(state);
+}
+
+static void ArithmeticSeriesSaturating(benchmark::State& state)
+{
+	arithmeticSeriesBenchmark<overflow::Saturating<std::uint64_t>>(state);
+}
+
+/*
+AddArrays
+*/
+
+__attribute((noinline)) void addPlain(
+	std::span<const std::int32_t> lhs, std::span<const std::int32_t> rhs,
+	std::span<std::int32_t> result)
+{
+	for (std::size_t i = 0; i < result.size(); ++i)
+	{
+		result[i] = static_cast<std::int32_t>(
+			static_cast<std::uint32_t>(lhs[i]) + static_cast<std::uint32_t>(rhs[i]));
+	}
+}
+
+__attribute((noinline)) bool addBuiltinLoop(
+	std::span<const std::int32_t> lhs, std::span<const std::int32_t> rhs,
+	std::span<std::int32_t> result)
+{
+	bool overflow {false};
+	for (std::size_t i = 0; i < result.size(); ++i)
+	{
+		overflow |= __builtin_add_overflow(lhs[i], rhs[i], &result[i]);
+	}
+	return overflow;
+}
+
+__attribute((noinline)) bool addChecked(
+	std::span<const std::int32_t> lhs, std::span<const std::int32_t> rhs,
+	std::span<std::int32_t> result)
+{
+	return overflow::addChecked(lhs, rhs, result);
+}
+
+__attribute((noinline)) void addSaturating(
+	std::span<const std::int32_t> lhs, std::span<const std::int32_t> rhs,
+	std::span<std::int32_t> result)
+{
+	overflow::addSaturating(lhs, rhs, result);
+}
+
+template <typename Add>
+static void addArraysBenchmark(benchmark::State& state, Add add)
+{
+	const std::vector<std::int32_t> lhs = getBuffer<std::int32_t>(state.range(0));
+	const std::vector<std::int32_t> rhs = getBuffer<std::int32_t>(state.range(0));
+	std::vector<std::int32_t> result(lhs.size());
+	for (auto _ : state)
+	{
+		add(lhs, rhs, result);
+		benchmark::DoNotOptimize(result.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	state.SetBytesProcessed(state.iterations() * state.range(0) * 3 * 4);
+}
+
+static void AddArraysPlain(benchmark::State& state)
+{
+	addArraysBenchmark(state, addPlain);
+}
+
+static void AddArraysBuiltinLoop(benchmark::State& state)
+{
+	addArraysBenchmark(state, addBuiltinLoop);
+}
+
+static void AddArraysChecked(benchmark::State& state)
+{
+	addArraysBenchmark(state, addChecked);
+}
+
+static void AddArraysSaturating(benchmark::State& state)
+{
+	addArraysBenchmark(state, addSaturating);
+}
+
+/*
+Sum
+*/
+
+__attribute((noinline)) std::int32_t sumPlain(std::span<const std::int32_t> values)
+{
+	std::uint32_t sum {0};
+	for (std::int32_t value : values)
+	{
+		sum += static_cast<std::uint32_t>(value);
+	}
+	return static_cast<std::int32_t>(sum);
+}
+
+__attribute((noinline)) std::int32_t sumChecked(std::span<const std::int32_t> values)
+{
+	return overflow::sumChecked(values).value();
+}
+
+template <typename Sum>
+static void sumBenchmark(benchmark::State& state, Sum sum)
+{
+	const std::vector<std::int32_t> values = getBuffer<std::int32_t>(state.range(0));
+	for (auto _ : state)
+	{
+		std::int32_t s = sum(values);
+		benchmark::DoNotOptimize(s);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	state.SetBytesProcessed(state.iterations() * state.range(0) * 4);
+}
+
+static void SumPlain(benchmark::State& state)
+{
+	sumBenchmark(state, sumPlain);
+}
+
+static void SumChecked(benchmark::State& state)
+{
+	sumBenchmark(state, sumChecked);
+}
+
+// clang-format off
+BENCHMARK(ArithmeticSeriesPlain)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(ArithmeticSeriesChecked)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(ArithmeticSeriesSaturating)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+
+BENCHMARK(AddArraysPlain)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(AddArraysBuiltinLoop)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(AddArraysChecked)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(AddArraysSaturating)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+
+BENCHMARK(SumPlain)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(SumChecked)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+// clang-format on
+
+BENCHMARK_MAIN();
@@ -0,0 +1,174 @@
+/*
+Reverse and strided loops, hand-written as in 'reverse_loop_template' in
+from_compiler_explorer.cpp against the adaptors in index_range.h. Every kernel
+sums a std::vector<std::int32_t> into an std::int64_t.
+
+- ReverseUnsigned: std::size_t index from size() - 1 while index < size(),
+  relying on the wrap-around after zero.
+- ReverseSigned: std::ptrdiff_t index from size() - 1 while index >= 0.
+- ReverseIndices: reverse_indices(data).
+- ReverseViews: std::views::reverse of std::views::iota, the standard library
+  way.
+- StridedSigned: every second element from the back, index -= 2 while
+  index >= 0.
+- StridedIndices: strided_range(size() - 1, (size() + 1) / 2, -2).
+
+The goal is for the adaptors to run exactly as fast as the hand-written
+loops, which requires that they are vectorized the same way. For the stride
+of -2 that depends on the target, SSE2 has no gather instructions.
+
+Build in Release mode, the kernels are meaningless without optimization:
+  cmake -S . -B build -DCMAKE_BUILD_TYPE=Release
+  cmake --build build --target reverse_bench
+
+Compare the inner loops in the disassembly, the kernels are noinline:
+  objdump -d --no-show-raw-insn -C build/signed_unsigned/reverse_bench | less
+*/
+
+#include "index_range.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <numeric>
+#include <ranges>
+#include <vector>
+
+// Same sizes as sum_loop_bench.cpp.
+constexpr std::int64_t MIN_SIZE {128};
+constexpr std::int64_t MAX_SIZE {std::int64_t {64} << 20};
+constexpr int SIZE_MULTIPLIER {8};
+
+std::vector<std::int32_t> getBuffer(std::int64_t size)
+{
+	std::vector<std::int32_t> buffer(static_cast<std::size_t>(size));
+	std::iota(buffer.begin(), buffer.end(), std::int32_t {1});
+	return buffer;
+}
+
+/*
+Reverse
+*/
+
+__attribute((noinline)) std::int64_t reverseUnsigned(const std::vector<std::int32_t>& data)
+{
+	std::int64_t sum {0};
+	for (std::size_t index = data.size() - 1; index < data.size(); --index)
+	{
+		sum += data[index];
+	}
+	return sum;
+}
+
+__attribute((noinline)) std::int64_t reverseSigned(const std::vector<std::int32_t>& data)
+{
+	std::int64_t sum {0};
+	for (std::ptrdiff_t index = std::ssize(data) - 1; index >= 0; --index)
+	{
+		sum += data[static_cast<std::size_t>(index)];
+	}
+	return sum;
+}
+
+__attribute((noinline)) std::int64_t reverseIndices(const std::vector<std::int32_t>& data)
+{
+	std::int64_t sum {0};
+	for (std::ptrdiff_t index : reverse_indices(data))
+	{
+		sum += data[static_cast<std::size_t>(index)];
+	}
+	return sum;
+}
+
+__attribute((noinline)) std::int64_t reverseViews(const std::vector<std::int32_t>& data)
+{
+	std::int64_t sum {0};
+	for (std::ptrdiff_t index :
+		 std::views::reverse(std::views::iota(std::ptrdiff_t {0}, std::ssize(data))))
+	{
+		sum += data[static_cast<std::size_t>(index)];
+	}
+	return sum;
+}
+
+/*
+Strided
+*/
+
+__attribute((noinline)) std::int64_t stridedSigned(const std::vector<std::int32_t>& data)
+{
+	std::int64_t sum {0};
+	for (std::ptrdiff_t index = std::ssize(data) - 1; index >= 0; index -= 2)
+	{
+		sum += data[static_cast<std::size_t>(index)];
+	}
+	return sum;
+}
+
+__attribute((noinline)) std::int64_t stridedIndices(const std::vector<std::int32_t>& data)
+{
+	std::int64_t sum {0};
+	const std::ptrdiff_t size = std::ssize(data);
+	for (std::ptrdiff_t index : strided_range(size - 1, (size + 1) / 2, -2))
+	{
+		sum += data[static_cast<std::size_t>(index)];
+	}
+	return sum;
+}
+
+template <typename Sum>
+static void sumBenchmark(benchmark::State& state, Sum sum)
+{
+	const std::vector<std::int32_t> buffer = getBuffer(state.range(0));
+	for (auto _ : state)
+	{
+		std::int64_t s = sum(buffer);
+		benchmark::DoNotOptimize(s);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	state.SetBytesProcessed(state.iterations() * state.range(0) * 4);
+}
+
+static void ReverseUnsigned(benchmark::State& state)
+{
+	sumBenchmark(state, reverseUnsigned);
+}
+
+static void ReverseSigned(benchmark::State& state)
+{
+	sumBenchmark(state, reverseSigned);
+}
+
+static void ReverseIndices(benchmark::State& state)
+{
+	sumBenchmark(state, reverseIndices);
+}
+
+static void ReverseViews(benchmark::State& state)
+{
+	sumBenchmark(state, reverseViews);
+}
+
+static void StridedSigned(benchmark::State& state)
+{
+	sumBenchmark(state, stridedSigned);
+}
+
+static void StridedIndices(benchmark::State& state)
+{
+	sumBenchmark(state, stridedIndices);
+}
+
+// clang-format off
+BENCHMARK(ReverseUnsigned)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(ReverseSigned)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(ReverseIndices)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(ReverseViews)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+
+BENCHMARK(StridedSigned)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(StridedIndices)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+// clang-format on
+
+BENCHMARK_MAIN();
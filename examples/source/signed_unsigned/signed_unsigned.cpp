@@ -1,3 +1,6 @@
+#include "average.h"
+#include "signed_vector.h"
+
 #include <iostream>
 #include <limits>
 #include <cstdint>
@@ -181,6 +184,15 @@ namespace add_and_divide_by_two
 	{
 		std::cout << add_and_divide_by_two(5l, 5l) << '\n';
 		std::cout << add_and_divide_by_two(5ul, 5ul) << '\n';
+
+		// The sum wraps around, midpoint from average.h never forms it. For
+		// int64_t the overflowing add_and_divide_by_two(large, large) would be
+		// undefined behavior, so only the unsigned version is called here.
+		const uint64_t large {std::numeric_limits<uint64_t>::max() - 1};
+		std::cout << "  add_and_divide_by_two: " << add_and_divide_by_two(large, large) << '\n';
+		std::cout << "  midpoint:              " << midpoint(large, large) << '\n';
+		const int64_t large_signed {std::numeric_limits<int64_t>::max() - 1};
+		std::cout << "  midpoint, signed:      " << midpoint(large_signed, large_signed) << '\n';
 	}
 }
 
@@ -215,11 +227,41 @@ namespace arithmetic_series
 	}
 }
 
+namespace signed_vector
+{
+	void header_size()
+	{
+		std::cout << "  sizeof(std::vector<int>): " << sizeof(std::vector<int>) << '\n';
+		std::cout << "  sizeof(Vector<int>): " << sizeof(Vector<int>) << '\n';
+		std::cout << "  sizeof(Vector<int, int32_t>): " << sizeof(Vector<int, int32_t>) << '\n';
+	}
+
+	void reverse_loop()
+	{
+		// With a signed size the obvious reverse loop terminates.
+		Vector<int, int32_t> data {1, 2, 3};
+		std::cout << "  reversed:";
+		for (int32_t index = data.size() - 1; index >= 0; --index)
+		{
+			std::cout << ' ' << data[index];
+		}
+		std::cout << '\n';
+	}
+
+	void run()
+	{
+		std::cout << "Vector:\n";
+		header_size();
+		reverse_loop();
+	}
+}
+
 int main()
 {
 	is_valid_index::run();
 	signed_to_unsigned_conversion::run();
 	add_and_divide_by_two::run();
 	arithmetic_series::run();
+	signed_vector::run();
 	return 0;
 }
@@ -0,0 +1,362 @@
+#pragma once
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+/*
+A std::vector with signed sizes and indices, of a selectable width.
+
+"Signed Vs Unsigned Integer Types.md" argues for signed sizes and indices:
+arithmetic on them doesn't silently wrap around to huge values, a negative
+index can be detected, and since signed overflow is undefined behavior the
+compiler may assume that a loop counter never wraps, which can give better
+loop code. std::vector's size_type is std::size_t, so every loop written
+against it either uses unsigned counters or converts. This Vector is written
+against IndexT throughout, std::ptrdiff_t by default.
+
+With a 32-bit IndexT the size and capacity are stored as 32 bits as well, and
+the vector is a pointer and two 32-bit integers, 16 bytes instead of 24. That
+matters for a struct containing many small vectors, or a vector of vectors.
+The price is a maximum size of 2^31 - 1 elements, and growing beyond that
+throws std::length_error.
+
+Indexing is bounds checked in debug builds, i.e. when NDEBUG isn't defined. An
+out-of-bounds or negative index executes __builtin_trap, stopping in the
+debugger right at the access instead of somewhere later. In release builds the
+check compiles to nothing, just like std::vector::operator[].
+
+Iterators are plain pointers.
+*/
+
+template <typename T, std::signed_integral IndexT = std::ptrdiff_t>
+class Vector
+{
+public:
+	using value_type = T;
+	using size_type = IndexT;
+	using difference_type = IndexT;
+	using iterator = T*;
+	using const_iterator = const T*;
+
+#if defined(NDEBUG)
+	static constexpr bool CHECK_BOUNDS {false};
+#else
+	static constexpr bool CHECK_BOUNDS {true};
+#endif
+
+	Vector() = default;
+
+	explicit Vector(IndexT size)
+		: Vector(size, T {})
+	{
+	}
+
+	// The uninitialized_* algorithms destroy what they constructed if a T
+	// constructor throws. The buffer itself is freed by the destructor, which
+	// runs for the delegated-to default constructor.
+
+	Vector(IndexT size, const T& value)
+		: Vector()
+	{
+		reserve(checkedSize(size));
+		std::uninitialized_fill_n(m_data, size, value);
+		m_size = size;
+	}
+
+	Vector(std::initializer_list<T> values)
+		: Vector()
+	{
+		reserve(checkedSize(values.size()));
+		std::uninitialized_copy(values.begin(), values.end(), m_data);
+		m_size = static_cast<IndexT>(values.size());
+	}
+
+	Vector(const Vector& other)
+		: Vector()
+	{
+		reserve(other.m_size);
+		std::uninitialized_copy(other.begin(), other.end(), m_data);
+		m_size = other.m_size;
+	}
+
+	Vector(Vector&& other) noexcept
+		: m_data(std::exchange(other.m_data, nullptr))
+		, m_size(std::exchange(other.m_size, 0))
+		, m_capacity(std::exchange(other.m_capacity, 0))
+	{
+	}
+
+	Vector& operator=(Vector other) noexcept
+	{
+		swap(other);
+		return *this;
+	}
+
+	~Vector()
+	{
+		clear();
+		deallocate(m_data, m_capacity);
+	}
+
+	void swap(Vector& other) noexcept
+	{
+		std::swap(m_data, other.m_data);
+		std::swap(m_size, other.m_size);
+		std::swap(m_capacity, other.m_capacity);
+	}
+
+	IndexT size() const
+	{
+		return m_size;
+	}
+
+	IndexT capacity() const
+	{
+		return m_capacity;
+	}
+
+	bool empty() const
+	{
+		return m_size == 0;
+	}
+
+	static constexpr IndexT max_size()
+	{
+		return std::numeric_limits<IndexT>::max();
+	}
+
+	T* data()
+	{
+		return m_data;
+	}
+
+	const T* data() const
+	{
+		return m_data;
+	}
+
+	T& operator[](IndexT index)
+	{
+		checkIndex(index);
+		return m_data[index];
+	}
+
+	const T& operator[](IndexT index) const
+	{
+		checkIndex(index);
+		return m_data[index];
+	}
+
+	/// Checked in all builds, throws std::out_of_range.
+	T& at(IndexT index)
+	{
+		if (index < 0 || index >= m_size)
+		{
+			throw std::out_of_range("Vector::at: index out of range.");
+		}
+		return m_data[index];
+	}
+
+	const T& at(IndexT index) const
+	{
+		return const_cast<Vector&>(*this).at(index);
+	}
+
+	T& front()
+	{
+		return (*this)[0];
+	}
+
+	const T& front() const
+	{
+		return (*this)[0];
+	}
+
+	T& back()
+	{
+		return (*this)[m_size - 1];
+	}
+
+	const T& back() const
+	{
+		return (*this)[m_size - 1];
+	}
+
+	iterator begin()
+	{
+		return m_data;
+	}
+
+	iterator end()
+	{
+		return m_data + m_size;
+	}
+
+	const_iterator begin() const
+	{
+		return m_data;
+	}
+
+	const_iterator end() const
+	{
+		return m_data + m_size;
+	}
+
+	void reserve(IndexT capacity)
+	{
+		if (capacity <= m_capacity)
+		{
+			return;
+		}
+		T* data = std::allocator<T>().allocate(static_cast<std::size_t>(capacity));
+		std::uninitialized_move(m_data, m_data + m_size, data);
+		std::destroy(m_data, m_data + m_size);
+		deallocate(m_data, m_capacity);
+		m_data = data;
+		m_capacity = capacity;
+	}
+
+	template <typename... Args>
+	T& emplace_back(Args&&... args)
+	{
+		if (m_size == m_capacity)
+		{
+			return reallocateAndEmplace(std::forward<Args>(args)...);
+		}
+		T* element = std::construct_at(m_data + m_size, std::forward<Args>(args)...);
+		++m_size;
+		return *element;
+	}
+
+	void push_back(const T& value)
+	{
+		emplace_back(value);
+	}
+
+	void push_back(T&& value)
+	{
+		emplace_back(std::move(value));
+	}
+
+	void pop_back()
+	{
+		checkIndex(m_size - 1);
+		--m_size;
+		std::destroy_at(m_data + m_size);
+	}
+
+	void resize(IndexT size)
+	{
+		checkedSize(size);
+		if (size < m_size)
+		{
+			std::destroy(m_data + size, m_data + m_size);
+		}
+		else
+		{
+			reserve(size);
+			std::uninitialized_value_construct(m_data + m_size, m_data + size);
+		}
+		m_size = size;
+	}
+
+	void clear()
+	{
+		std::destroy(m_data, m_data + m_size);
+		m_size = 0;
+	}
+
+private:
+	void checkIndex([[maybe_unused]] IndexT index) const
+	{
+		if constexpr (CHECK_BOUNDS)
+		{
+			if (index < 0 || index >= m_size)
+			{
+				__builtin_trap();
+			}
+		}
+	}
+
+	/// emplace_back into a full vector. The new element is constructed in the
+	/// new buffer before the old elements are moved out of the old one, since
+	/// 'args' may refer to one of them, as in v.push_back(v.back()).
+	template <typename... Args>
+	T& reallocateAndEmplace(Args&&... args)
+	{
+		const IndexT capacity = grownCapacity();
+		T* data = std::allocator<T>().allocate(static_cast<std::size_t>(capacity));
+		T* element {nullptr};
+		try
+		{
+			element = std::construct_at(data + m_size, std::forward<Args>(args)...);
+			std::uninitialized_move(m_data, m_data + m_size, data);
+		}
+		catch (...)
+		{
+			if (element != nullptr)
+			{
+				std::destroy_at(element);
+			}
+			std::allocator<T>().deallocate(data, static_cast<std::size_t>(capacity));
+			throw;
+		}
+		std::destroy(m_data, m_data + m_size);
+		deallocate(m_data, m_capacity);
+		m_data = data;
+		m_capacity = capacity;
+		++m_size;
+		return *element;
+	}
+
+	IndexT grownCapacity() const
+	{
+		if (m_capacity == max_size())
+		{
+			throw std::length_error("Vector: size would exceed max_size().");
+		}
+		if (m_capacity > max_size() / 2)
+		{
+			return max_size();
+		}
+		return std::max(IndexT {4}, static_cast<IndexT>(2 * m_capacity));
+	}
+
+	static IndexT checkedSize(IndexT size)
+	{
+		if (size < 0)
+		{
+			throw std::length_error("Vector: negative size.");
+		}
+		return size;
+	}
+
+	static IndexT checkedSize(std::size_t size)
+	{
+		if (size > static_cast<std::size_t>(max_size()))
+		{
+			throw std::length_error("Vector: size would exceed max_size().");
+		}
+		return static_cast<IndexT>(size);
+	}
+
+	static void deallocate(T* data, IndexT capacity)
+	{
+		if (data != nullptr)
+		{
+			std::allocator<T>().deallocate(data, static_cast<std::size_t>(capacity));
+		}
+	}
+
+private:
+	T* m_data {nullptr};
+	IndexT m_size {0};
+	IndexT m_capacity {0};
+};
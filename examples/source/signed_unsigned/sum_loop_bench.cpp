@@ -0,0 +1,291 @@
+/*
+Benchmarks for the loop counter experiments in from_compiler_explorer.cpp.
+
+These started out as quick-bench.com snippets, see "Signed Vs Unsigned
+Integer Types - Source Notes.md", and the results were saved as screenshots.
+Here they are as a Google Benchmark program so they can be run on any machine
+and for a range of buffer sizes. The kernels are copies of the ones in
+from_compiler_explorer.cpp, that file is meant to be pasted into Compiler
+Explorer as-is and therefore cannot be included from here.
+
+Build in Release mode, the kernels are meaningless without optimization:
+  cmake -S . -B build -DCMAKE_BUILD_TYPE=Release
+  cmake --build build --target sum_loop_bench
+
+Write the results as JSON:
+  ./build/signed_unsigned/sum_loop_bench --benchmark_out=sum_loop.json --benchmark_out_format=json
+
+Run a subset, e.g. only the 1024 element runs:
+  ./build/signed_unsigned/sum_loop_bench --benchmark_filter=/1024$
+*/
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+// 128 elements to 64 Mi elements. The smallest fits in L1, the largest is
+// far larger than any last level cache.
+constexpr std::int64_t MIN_SIZE {128};
+constexpr std::int64_t MAX_SIZE {std::int64_t {64} << 20};
+constexpr int SIZE_MULTIPLIER {8};
+
+template <typename T>
+std::vector<T> getBuffer(std::int64_t size)
+{
+	std::vector<T> buffer(static_cast<std::size_t>(size));
+	std::iota(buffer.begin(), buffer.end(), T {1});
+	return buffer;
+}
+
+template <typename T>
+void setProcessed(benchmark::State& state)
+{
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	state.SetBytesProcessed(state.iterations() * state.range(0) * std::int64_t(sizeof(T)));
+}
+
+// Cost of the benchmark loop itself, everything else should be compared
+// against this.
+static void baseline(benchmark::State& state)
+{
+	std::vector<double> buffer = getBuffer<double>(state.range(0));
+	for (auto _ : state)
+	{
+		double* data = buffer.data();
+		benchmark::DoNotOptimize(data);
+	}
+}
+
+/*
+sum
+*/
+
+// 32-bit unsigned both for the size and the counter.
+__attribute((noinline)) double sum(double* data, unsigned int size)
+{
+	double sum {0.0};
+	for (unsigned int index = 0; index < size; ++index)
+	{
+		sum += data[index];
+	}
+	return sum;
+}
+
+// 32-bit signed both for the size and the counter.
+__attribute((noinline)) double sum(double* data, int size)
+{
+	double sum {0.0};
+	for (int index = 0; index < size; ++index)
+	{
+		sum += data[index];
+	}
+	return sum;
+}
+
+// 64-bit signed for the size, 32-bit signed for the counter.
+__attribute((noinline)) double sum(double* data, std::ptrdiff_t size)
+{
+	double sum {0.0};
+	for (int index = 0; index < size; ++index)
+	{
+		sum += data[index];
+	}
+	return sum;
+}
+
+// 64-bit unsigned for the size, 32-bit unsigned for  the counter.
+// The compiler must ensure that ++index wraps properly.
+__attribute((noinline)) double sum(double* data, std::size_t size)
+{
+	double sum {0.0};
+	for (unsigned int index = 0; index < size; ++index)
+	{
+		sum += data[index];
+	}
+	return sum;
+}
+
+template <typename SizeType>
+static void sumBenchmark(benchmark::State& state)
+{
+	std::vector<double> buffer = getBuffer<double>(state.range(0));
+	for (auto _ : state)
+	{
+		double s = sum(buffer.data(), static_cast<SizeType>(buffer.size()));
+		benchmark::DoNotOptimize(s);
+	}
+	setProcessed<double>(state);
+}
+
+static void SumUIntUInt(benchmark::State& state)
+{
+	sumBenchmark<unsigned int>(state);
+}
+
+static void SumIntInt(benchmark::State& state)
+{
+	sumBenchmark<int>(state);
+}
+
+static void SumPtrdiffInt(benchmark::State& state)
+{
+	sumBenchmark<std::ptrdiff_t>(state);
+}
+
+static void SumSizeUInt(benchmark::State& state)
+{
+	sumBenchmark<std::size_t>(state);
+}
+
+/*
+sum_range
+*/
+
+__attribute((noinline)) std::ptrdiff_t sum_range(std::ptrdiff_t n)
+{
+	std::ptrdiff_t sum {0};
+	for (std::ptrdiff_t i = 1; i <= n; ++i)
+	{
+		sum += i;
+	}
+	return sum;
+}
+
+__attribute((noinline)) std::size_t sum_range(std::size_t n)
+{
+	std::size_t sum {0};
+	for (std::size_t i = 1; i <= n; ++i)
+	{
+		sum += i;
+	}
+	return sum;
+}
+
+__attribute((noinline)) unsigned sum_range(unsigned n)
+{
+	unsigned sum {0};
+	for (unsigned i = 1; i <= n; ++i)
+	{
+		sum += i;
+	}
+	return sum;
+}
+
+template <typename IntegerType>
+static void sumRangeBenchmark(benchmark::State& state)
+{
+	// No buffer here, sum_range only does arithmetic on the loop counter.
+	// The signed version may be replaced by the closed form n * (n + 1) / 2.
+	IntegerType n {static_cast<IntegerType>(state.range(0))};
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(n);
+		IntegerType s = sum_range(n);
+		benchmark::DoNotOptimize(s);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void SumRangePtrdiff(benchmark::State& state)
+{
+	sumRangeBenchmark<std::ptrdiff_t>(state);
+}
+
+static void SumRangeSize(benchmark::State& state)
+{
+	sumRangeBenchmark<std::size_t>(state);
+}
+
+static void SumRangeUnsigned(benchmark::State& state)
+{
+	sumRangeBenchmark<unsigned>(state);
+}
+
+/*
+average
+*/
+
+__attribute((noinline)) double average(int64_t* data, int64_t num)
+{
+	int64_t sum {0};
+	for (int64_t i = 0; i < num; ++i)
+	{
+		sum += data[i];
+	}
+	return static_cast<double>(sum) / static_cast<double>(num);
+}
+
+__attribute((noinline)) double average(uint64_t* data, uint64_t num)
+{
+	uint64_t sum {0};
+	for (uint64_t i = 0; i < num; ++i)
+	{
+		sum += data[i];
+	}
+	return static_cast<double>(sum) / static_cast<double>(num);
+}
+
+__attribute((noinline)) double average_small(uint64_t* data, uint64_t num)
+{
+	uint64_t sum {0};
+	for (uint64_t i = 0; i < num; ++i)
+	{
+		sum += data[i];
+	}
+	return static_cast<double>((int64_t) sum) / static_cast<double>((int64_t) num);
+}
+
+static void AverageInt64(benchmark::State& state)
+{
+	std::vector<int64_t> buffer = getBuffer<int64_t>(state.range(0));
+	for (auto _ : state)
+	{
+		double a = average(buffer.data(), static_cast<int64_t>(buffer.size()));
+		benchmark::DoNotOptimize(a);
+	}
+	setProcessed<int64_t>(state);
+}
+
+static void AverageUInt64(benchmark::State& state)
+{
+	std::vector<uint64_t> buffer = getBuffer<uint64_t>(state.range(0));
+	for (auto _ : state)
+	{
+		double a = average(buffer.data(), static_cast<uint64_t>(buffer.size()));
+		benchmark::DoNotOptimize(a);
+	}
+	setProcessed<uint64_t>(state);
+}
+
+static void AverageSmallUInt64(benchmark::State& state)
+{
+	std::vector<uint64_t> buffer = getBuffer<uint64_t>(state.range(0));
+	for (auto _ : state)
+	{
+		double a = average_small(buffer.data(), static_cast<uint64_t>(buffer.size()));
+		benchmark::DoNotOptimize(a);
+	}
+	setProcessed<uint64_t>(state);
+}
+
+// clang-format off
+BENCHMARK(baseline)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+
+BENCHMARK(SumUIntUInt)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(SumIntInt)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(SumPtrdiffInt)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(SumSizeUInt)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+
+BENCHMARK(SumRangePtrdiff)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(SumRangeSize)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(SumRangeUnsigned)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+
+BENCHMARK(AverageInt64)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(AverageUInt64)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(AverageSmallUInt64)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+// clang-format on
+
+BENCHMARK_MAIN();
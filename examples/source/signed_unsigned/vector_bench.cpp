@@ -0,0 +1,212 @@
+/*
+Loops over std::vector and over the signed-index Vector from signed_vector.h,
+with the loop counter of the container's own size type. The question is
+whether signed counters really give better loop code, as claimed in
+"Signed Vs Unsigned Integer Types.md".
+
+- StdVectorSize: std::vector<double> and std::size_t, the usual way.
+- StdVectorUInt: std::vector<double> and a 32-bit unsigned counter. The counter
+  must wrap at 2^32, which the compiler has to preserve.
+- VectorInt32: Vector<double, std::int32_t> and std::int32_t.
+- VectorPtrdiff: Vector<double> and std::ptrdiff_t.
+
+Sum reads every element once. PairProduct computes data[2 * i] * data[2 * i
++ 1], where the index arithmetic can overflow and wrap, so unsigned counters
+there can't be widened to 64-bit pointer arithmetic as freely.
+
+Build in Release mode, the kernels are meaningless without optimization.
+NDEBUG is then defined, so Vector's bounds checks are compiled out:
+  cmake -S . -B build -DCMAKE_BUILD_TYPE=Release
+  cmake --build build --target vector_bench
+
+Compare the inner loops in the disassembly, the kernels are noinline:
+  objdump -d --no-show-raw-insn -C build/signed_unsigned/vector_bench | less
+*/
+
+#include "signed_vector.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// 128 elements to 16 Mi elements, as in sum_loop_bench.cpp but stopping
+// earlier since there are two containers per run.
+constexpr std::int64_t MIN_SIZE {128};
+constexpr std::int64_t MAX_SIZE {std::int64_t {16} << 20};
+constexpr int SIZE_MULTIPLIER {8};
+
+template <typename Container>
+Container getBuffer(std::int64_t size)
+{
+	Container buffer;
+	buffer.resize(static_cast<typename Container::size_type>(size));
+	double value {1.0};
+	for (double& element : buffer)
+	{
+		element = value;
+		value += 1.0;
+	}
+	return buffer;
+}
+
+/*
+Sum
+*/
+
+__attribute((noinline)) double sum(const std::vector<double>& data)
+{
+	double sum {0.0};
+	for (std::size_t index = 0; index < data.size(); ++index)
+	{
+		sum += data[index];
+	}
+	return sum;
+}
+
+__attribute((noinline)) double sumUInt(const std::vector<double>& data)
+{
+	double sum {0.0};
+	for (unsigned int index = 0; index < data.size(); ++index)
+	{
+		sum += data[index];
+	}
+	return sum;
+}
+
+__attribute((noinline)) double sum(const Vector<double, std::int32_t>& data)
+{
+	double sum {0.0};
+	for (std::int32_t index = 0; index < data.size(); ++index)
+	{
+		sum += data[index];
+	}
+	return sum;
+}
+
+__attribute((noinline)) double sum(const Vector<double>& data)
+{
+	double sum {0.0};
+	for (std::ptrdiff_t index = 0; index < data.size(); ++index)
+	{
+		sum += data[index];
+	}
+	return sum;
+}
+
+/*
+PairProduct
+*/
+
+__attribute((noinline)) double pairProduct(const std::vector<double>& data)
+{
+	double sum {0.0};
+	for (std::size_t index = 0; index < data.size() / 2; ++index)
+	{
+		sum += data[2 * index] * data[2 * index + 1];
+	}
+	return sum;
+}
+
+__attribute((noinline)) double pairProductUInt(const std::vector<double>& data)
+{
+	double sum {0.0};
+	const auto half = static_cast<unsigned int>(data.size() / 2);
+	for (unsigned int index = 0; index < half; ++index)
+	{
+		sum += data[2 * index] * data[2 * index + 1];
+	}
+	return sum;
+}
+
+__attribute((noinline)) double pairProduct(const Vector<double, std::int32_t>& data)
+{
+	double sum {0.0};
+	for (std::int32_t index = 0; index < data.size() / 2; ++index)
+	{
+		sum += data[2 * index] * data[2 * index + 1];
+	}
+	return sum;
+}
+
+__attribute((noinline)) double pairProduct(const Vector<double>& data)
+{
+	double sum {0.0};
+	for (std::ptrdiff_t index = 0; index < data.size() / 2; ++index)
+	{
+		sum += data[2 * index] * data[2 * index + 1];
+	}
+	return sum;
+}
+
+template <typename Container, typename Kernel>
+void run(benchmark::State& state, Kernel kernel)
+{
+	const Container buffer = getBuffer<Container>(state.range(0));
+	for (auto _ : state)
+	{
+		double s = kernel(buffer);
+		benchmark::DoNotOptimize(s);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	state.SetBytesProcessed(state.iterations() * state.range(0) * std::int64_t(sizeof(double)));
+}
+
+using StdVector = std::vector<double>;
+using VectorInt32 = Vector<double, std::int32_t>;
+using VectorPtrdiff = Vector<double>;
+
+static void SumStdVectorSize(benchmark::State& state)
+{
+	run<StdVector>(state, [](const StdVector& data) { return sum(data); });
+}
+
+static void SumStdVectorUInt(benchmark::State& state)
+{
+	run<StdVector>(state, [](const StdVector& data) { return sumUInt(data); });
+}
+
+static void SumVectorInt32(benchmark::State& state)
+{
+	run<VectorInt32>(state, [](const VectorInt32& data) { return sum(data); });
+}
+
+static void SumVectorPtrdiff(benchmark::State& state)
+{
+	run<VectorPtrdiff>(state, [](const VectorPtrdiff& data) { return sum(data); });
+}
+
+static void PairProductStdVectorSize(benchmark::State& state)
+{
+	run<StdVector>(state, [](const StdVector& data) { return pairProduct(data); });
+}
+
+static void PairProductStdVectorUInt(benchmark::State& state)
+{
+	run<StdVector>(state, [](const StdVector& data) { return pairProductUInt(data); });
+}
+
+static void PairProductVectorInt32(benchmark::State& state)
+{
+	run<VectorInt32>(state, [](const VectorInt32& data) { return pairProduct(data); });
+}
+
+static void PairProductVectorPtrdiff(benchmark::State& state)
+{
+	run<VectorPtrdiff>(state, [](const VectorPtrdiff& data) { return pairProduct(data); });
+}
+
+// clang-format off
+BENCHMARK(SumStdVectorSize)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(SumStdVectorUInt)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(SumVectorInt32)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(SumVectorPtrdiff)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+
+BENCHMARK(PairProductStdVectorSize)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(PairProductStdVectorUInt)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(PairProductVectorInt32)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+BENCHMARK(PairProductVectorPtrdiff)->RangeMultiplier(SIZE_MULTIPLIER)->Range(MIN_SIZE, MAX_SIZE);
+// clang-format on
+
+BENCHMARK_MAIN();
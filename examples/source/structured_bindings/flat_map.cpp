@@ -0,0 +1,104 @@
+#include "flat_map.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+template <typename Function>
+double milliseconds(Function function)
+{
+	const auto start = std::chrono::steady_clock::now();
+	function();
+	const auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+using Pairs = std::vector<std::pair<std::uint32_t, std::uint32_t>>;
+
+Pairs makePairs(int num_pairs)
+{
+	std::mt19937 random(1234);
+	Pairs pairs;
+	pairs.reserve(static_cast<std::size_t>(num_pairs));
+	for (int i = 0; i < num_pairs; ++i)
+	{
+		pairs.emplace_back(random(), i);
+	}
+	return pairs;
+}
+
+/// Look up every key in 'lookups' and add up the values found.
+template <typename Map>
+std::uint64_t sumFound(const Map& map, const std::vector<std::uint32_t>& lookups)
+{
+	std::uint64_t sum {0};
+	for (std::uint32_t key : lookups)
+	{
+		if (auto it = map.find(key); it != map.end())
+		{
+			sum += it->second;
+		}
+	}
+	return sum;
+}
+
+/// Update every value, the loop from structured_bindings.cpp.
+template <typename Map>
+void updateAll(Map& map)
+{
+	for (auto& [key, value] : map)
+	{
+		value = key / 2;
+	}
+}
+
+void lookup_and_iterate(int num_keys)
+{
+	std::cout << "\n# " << __FUNCTION__ << ", " << num_keys << " keys\n";
+
+	const Pairs pairs = makePairs(num_keys);
+	std::map<std::uint32_t, std::uint32_t> tree;
+	FlatMap<std::uint32_t, std::uint32_t> binary;
+	FlatMap<std::uint32_t, std::uint32_t, std::less<>, FlatMapLookup::Eytzinger> eytzinger;
+
+	const double tree_build_ms = milliseconds([&]() { tree.insert(pairs.begin(), pairs.end()); });
+	const double binary_build_ms =
+		milliseconds([&]() { binary.insert_sorted(pairs.begin(), pairs.end()); });
+	eytzinger.insert_sorted(pairs.begin(), pairs.end());
+
+	// Half of the lookups are hits.
+	std::mt19937 random(5678);
+	std::vector<std::uint32_t> lookups;
+	for (int i = 0; i < 1'000'000; ++i)
+	{
+		lookups.push_back(i % 2 == 0 ? pairs[random() % pairs.size()].first : random());
+	}
+
+	std::uint64_t sums[3] {};
+	const double tree_find_ms = milliseconds([&]() { sums[0] = sumFound(tree, lookups); });
+	const double binary_find_ms = milliseconds([&]() { sums[1] = sumFound(binary, lookups); });
+	const double eytzinger_find_ms =
+		milliseconds([&]() { sums[2] = sumFound(eytzinger, lookups); });
+
+	const double tree_update_ms = milliseconds([&]() { updateAll(tree); });
+	const double flat_update_ms = milliseconds([&]() { updateAll(binary); });
+
+	std::cout << "  Bulk insert, std::map:       " << tree_build_ms << " ms\n";
+	std::cout << "  Bulk insert, FlatMap:        " << binary_build_ms << " ms\n";
+	std::cout << "  1M finds, std::map:          " << tree_find_ms << " ms\n";
+	std::cout << "  1M finds, binary search:     " << binary_find_ms << " ms\n";
+	std::cout << "  1M finds, Eytzinger:         " << eytzinger_find_ms << " ms\n";
+	std::cout << "  Update all, std::map:        " << tree_update_ms << " ms\n";
+	std::cout << "  Update all, FlatMap:         " << flat_update_ms << " ms\n";
+	std::cout << "  Same results: " << (sums[0] == sums[1] && sums[1] == sums[2]) << '\n';
+}
+
+int main()
+{
+	lookup_and_iterate(10'000);
+	lookup_and_iterate(1'000'000);
+}
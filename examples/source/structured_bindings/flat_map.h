@@ -0,0 +1,400 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+An ordered map stored as two sorted arrays, one of keys and one of values.
+
+Iterating over a std::map follows a pointer from every node to the next, and
+the nodes are wherever the allocator put them. Here the keys are contiguous
+and so are the values, iteration is a linear walk over two arrays, and a
+lookup only touches keys. The price is that inserting or erasing a single
+element shifts everything after it. Build the map in bulk with
+'insert_sorted', or with a sorted range in the constructor, and then read and
+update values in place.
+
+Lookup is a binary search over the key array or, with
+FlatMapLookup::Eytzinger, a search over a copy of the keys in Eytzinger
+layout. That is the keys in breadth-first order of the implicit binary search
+tree: the root first, then its two children, then their four children, and so
+on. The first few levels of every search share a few cache lines, and the 16
+descendants four levels below a node are adjacent in memory and can be
+prefetched while the search works its way down to them. The copy is rebuilt
+on every change to the set of keys, which does not change the complexity of a
+single insert or erase, both are O(n) already.
+
+Iteration produces a proxy with 'first' and 'second' reference members, so
+that
+
+	for (auto& [key, value] : table)
+
+works just as for a std::map, with 'key' a const reference into the key array
+and 'value' a reference into the value array. The proxy lives in the iterator,
+so the iterators are enough for range-based for loops and the simpler
+algorithms but aren't proper forward iterators.
+*/
+
+enum class FlatMapLookup
+{
+	BinarySearch,
+	Eytzinger
+};
+
+template <
+	typename Key, typename Value, typename Compare = std::less<Key>,
+	FlatMapLookup Lookup = FlatMapLookup::BinarySearch>
+class FlatMap
+{
+public:
+	using key_type = Key;
+	using mapped_type = Value;
+
+	/// What iterating produces, the key and value of one element.
+	template <typename V>
+	struct Element
+	{
+		const Key& first;
+		V& second;
+	};
+
+	template <bool Const>
+	class Iterator;
+
+	using iterator = Iterator<false>;
+	using const_iterator = Iterator<true>;
+
+	FlatMap() = default;
+
+	/// Build from pairs in any order. For duplicate keys the first one is kept.
+	FlatMap(std::initializer_list<std::pair<Key, Value>> elements)
+	{
+		insert_sorted(elements.begin(), elements.end());
+	}
+
+	std::ptrdiff_t size() const
+	{
+		return std::ssize(m_keys);
+	}
+
+	bool empty() const
+	{
+		return m_keys.empty();
+	}
+
+	void reserve(std::ptrdiff_t capacity)
+	{
+		m_keys.reserve(static_cast<std::size_t>(capacity));
+		m_values.reserve(static_cast<std::size_t>(capacity));
+	}
+
+	void clear()
+	{
+		m_keys.clear();
+		m_values.clear();
+		rebuildSearchTree();
+	}
+
+	std::span<const Key> keys() const
+	{
+		return m_keys;
+	}
+
+	std::span<Value> values()
+	{
+		return m_values;
+	}
+
+	std::span<const Value> values() const
+	{
+		return m_values;
+	}
+
+	/// Insert every pair in [first, last) whose key isn't in the map already.
+	/// The pairs need not be sorted. O((n + m) + m log m) for m new pairs.
+	template <typename InputIterator>
+	void insert_sorted(InputIterator first, InputIterator last)
+	{
+		std::vector<std::pair<Key, Value>> incoming(first, last);
+		std::stable_sort(
+			incoming.begin(), incoming.end(),
+			[this](const auto& lhs, const auto& rhs) { return m_compare(lhs.first, rhs.first); });
+
+		// Merge the two sorted sequences into new arrays. On equal keys the one
+		// already in the map, or the earlier of the incoming, wins.
+		std::vector<Key> keys;
+		std::vector<Value> values;
+		keys.reserve(m_keys.size() + incoming.size());
+		values.reserve(m_keys.size() + incoming.size());
+		std::size_t existing {0};
+		for (auto& [key, value] : incoming)
+		{
+			while (existing < m_keys.size() && m_compare(m_keys[existing], key))
+			{
+				keys.push_back(std::move(m_keys[existing]));
+				values.push_back(std::move(m_values[existing]));
+				++existing;
+			}
+			const bool duplicate =
+				(existing < m_keys.size() && !m_compare(key, m_keys[existing])) ||
+				(!keys.empty() && !m_compare(keys.back(), key));
+			if (!duplicate)
+			{
+				keys.push_back(std::move(key));
+				values.push_back(std::move(value));
+			}
+		}
+		for (; existing < m_keys.size(); ++existing)
+		{
+			keys.push_back(std::move(m_keys[existing]));
+			values.push_back(std::move(m_values[existing]));
+		}
+
+		m_keys = std::move(keys);
+		m_values = std::move(values);
+		rebuildSearchTree();
+	}
+
+	/// Insert a single element, O(n). Returns the element with 'key' and
+	/// whether it was inserted.
+	std::pair<iterator, bool> insert(Key key, Value value)
+	{
+		const std::ptrdiff_t position = lowerBound(key);
+		if (position < size() && !m_compare(key, m_keys[static_cast<std::size_t>(position)]))
+		{
+			return {iterator(this, position), false};
+		}
+		m_keys.insert(m_keys.begin() + position, std::move(key));
+		m_values.insert(m_values.begin() + position, std::move(value));
+		rebuildSearchTree();
+		return {iterator(this, position), true};
+	}
+
+	Value& operator[](const Key& key)
+	{
+		return insert(key, Value {}).first->second;
+	}
+
+	/// Remove the element with 'key'. Returns the number of elements removed.
+	std::ptrdiff_t erase(const Key& key)
+	{
+		const std::ptrdiff_t position = find_position(key);
+		if (position == size())
+		{
+			return 0;
+		}
+		m_keys.erase(m_keys.begin() + position);
+		m_values.erase(m_values.begin() + position);
+		rebuildSearchTree();
+		return 1;
+	}
+
+	/// Position of 'key' in 'keys()', or size() if not present.
+	std::ptrdiff_t find_position(const Key& key) const
+	{
+		const std::ptrdiff_t position = lowerBound(key);
+		if (position < size() && !m_compare(key, m_keys[static_cast<std::size_t>(position)]))
+		{
+			return position;
+		}
+		return size();
+	}
+
+	iterator find(const Key& key)
+	{
+		return iterator(this, find_position(key));
+	}
+
+	const_iterator find(const Key& key) const
+	{
+		return const_iterator(this, find_position(key));
+	}
+
+	bool contains(const Key& key) const
+	{
+		return find_position(key) != size();
+	}
+
+	Value& at(const Key& key)
+	{
+		const std::ptrdiff_t position = find_position(key);
+		if (position == size())
+		{
+			throw std::out_of_range("FlatMap::at: key not found.");
+		}
+		return m_values[static_cast<std::size_t>(position)];
+	}
+
+	const Value& at(const Key& key) const
+	{
+		return const_cast<FlatMap&>(*this).at(key);
+	}
+
+	iterator begin()
+	{
+		return iterator(this, 0);
+	}
+
+	iterator end()
+	{
+		return iterator(this, size());
+	}
+
+	const_iterator begin() const
+	{
+		return const_iterator(this, 0);
+	}
+
+	const_iterator end() const
+	{
+		return const_iterator(this, size());
+	}
+
+	template <bool Const>
+	class Iterator
+	{
+	public:
+		using Map = std::conditional_t<Const, const FlatMap, FlatMap>;
+		using value_type = Element<std::conditional_t<Const, const Value, Value>>;
+		using reference = value_type&;
+		using pointer = value_type*;
+		using difference_type = std::ptrdiff_t;
+		using iterator_category = std::input_iterator_tag;
+
+		Iterator() = default;
+
+		Iterator(Map* map, std::ptrdiff_t position)
+			: m_map(map)
+			, m_position(position)
+		{
+		}
+
+		// The stashed element holds references and can't be reassigned, so
+		// copies start without one and the next operator* builds it again.
+		Iterator(const Iterator& other)
+			: m_map(other.m_map)
+			, m_position(other.m_position)
+		{
+		}
+
+		Iterator& operator=(const Iterator& other)
+		{
+			m_map = other.m_map;
+			m_position = other.m_position;
+			m_element.reset();
+			return *this;
+		}
+
+		std::ptrdiff_t position() const
+		{
+			return m_position;
+		}
+
+		reference operator*() const
+		{
+			const auto index = static_cast<std::size_t>(m_position);
+			m_element.emplace(value_type {m_map->m_keys[index], m_map->m_values[index]});
+			return *m_element;
+		}
+
+		pointer operator->() const
+		{
+			return &**this;
+		}
+
+		Iterator& operator++()
+		{
+			++m_position;
+			return *this;
+		}
+
+		Iterator operator++(int)
+		{
+			Iterator previous = *this;
+			++m_position;
+			return previous;
+		}
+
+		friend bool operator==(const Iterator& lhs, const Iterator& rhs)
+		{
+			return lhs.m_position == rhs.m_position;
+		}
+
+	private:
+		Map* m_map {nullptr};
+		std::ptrdiff_t m_position {0};
+		mutable std::optional<value_type> m_element;
+	};
+
+private:
+	std::ptrdiff_t lowerBound(const Key& key) const
+	{
+		if constexpr (Lookup == FlatMapLookup::BinarySearch)
+		{
+			return std::lower_bound(m_keys.begin(), m_keys.end(), key, m_compare) - m_keys.begin();
+		}
+		else
+		{
+			// Walk down the tree, going right when the node is less than the key.
+			// The walk ends at a node index past the end. Its bits record the
+			// path, a 1 for every right turn, and the lower bound is the node
+			// where the path last turned left: drop the trailing right turns,
+			// then the final left turn.
+			const std::size_t n = m_keys.size();
+			std::size_t node {1};
+			while (node <= n)
+			{
+				__builtin_prefetch(m_tree_keys.data() + std::min(node * 16, n));
+				node = 2 * node + m_compare(m_tree_keys[node], key);
+			}
+			node >>= std::countr_one(node) + 1;
+			return node == 0 ? size() : m_tree_positions[node];
+		}
+	}
+
+	/// Copy the keys into Eytzinger layout, where node k's children are nodes
+	/// 2k and 2k + 1, and node 0 is unused.
+	void rebuildSearchTree()
+	{
+		if constexpr (Lookup == FlatMapLookup::Eytzinger)
+		{
+			m_tree_keys.resize(m_keys.size() + 1);
+			m_tree_positions.resize(m_keys.size() + 1);
+			std::ptrdiff_t next {0};
+			fillSearchTree(1, next);
+		}
+	}
+
+	/// In-order traversal of the implicit tree, which visits the nodes in key order.
+	void fillSearchTree(std::size_t node, std::ptrdiff_t& next)
+	{
+		if (node < m_tree_keys.size())
+		{
+			fillSearchTree(2 * node, next);
+			m_tree_keys[node] = m_keys[static_cast<std::size_t>(next)];
+			m_tree_positions[node] = next;
+			++next;
+			fillSearchTree(2 * node + 1, next);
+		}
+	}
+
+private:
+	std::vector<Key> m_keys;
+	std::vector<Value> m_values;
+	/// Only used with FlatMapLookup::Eytzinger.
+	std::vector<Key> m_tree_keys;
+	std::vector<std::ptrdiff_t> m_tree_positions;
+	[[no_unique_address]] Compare m_compare;
+};
@@ -0,0 +1,101 @@
+#include "flat_map.h"
+#include "parallel_update.h"
+#include "swiss_map.h"
+#include "thread_pool.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <map>
+
+template <typename Function>
+double milliseconds(Function function)
+{
+	const auto start = std::chrono::steady_clock::now();
+	function();
+	const auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+// Same as in structured_bindings.cpp.
+template <typename Map, typename Function>
+void update(Map& table, Function getNewValueForKey)
+{
+	for (auto& [key, value] : table)
+	{
+		value = getNewValueForKey(key);
+	}
+}
+
+/// Stands in for an expensive per-key computation, a few hundred rounds of
+/// a hash function.
+std::uint64_t expensive(int key)
+{
+	std::uint64_t hash = static_cast<std::uint64_t>(key);
+	for (int round = 0; round < 500; ++round)
+	{
+		hash ^= hash >> 31;
+		hash *= 0x9E37'79B9'7F4A'7C15ULL;
+	}
+	return hash;
+}
+
+template <typename Map>
+std::uint64_t checksum(const Map& table)
+{
+	std::uint64_t sum {0};
+	for (auto [key, value] : table)
+	{
+		sum += value ^ static_cast<std::uint64_t>(key);
+	}
+	return sum;
+}
+
+template <typename Map>
+void compare(const char* name, Map& table, ThreadPool& pool)
+{
+	const double serial_ms = milliseconds([&]() { update(table, expensive); });
+	const std::uint64_t serial_sum = checksum(table);
+	update(table, [](int) { return std::uint64_t {0}; });
+
+	const double parallel_ms = milliseconds([&]() { parallelUpdate(pool, table, expensive); });
+	const std::uint64_t parallel_sum = checksum(table);
+
+	std::cout << "  " << name << ": serial " << serial_ms << " ms, parallel " << parallel_ms
+			  << " ms, same result " << (serial_sum == parallel_sum) << '\n';
+}
+
+/// Needs more than one core to show a speedup.
+void serial_vs_parallel()
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	constexpr int num_keys {100'000};
+	ThreadPool pool;
+	std::cout << "  " << pool.numThreads() << " threads\n";
+
+	std::map<int, std::uint64_t> tree;
+	FlatMap<int, std::uint64_t> flat;
+	SwissMap<int, std::uint64_t> swiss;
+	for (int key = 0; key < num_keys; ++key)
+	{
+		tree[key] = 0;
+		flat[key] = 0;
+		swiss[key] = 0;
+	}
+
+	compare("std::map", tree, pool);
+	compare("FlatMap ", flat, pool);
+	compare("SwissMap", swiss, pool);
+
+#if defined(HAVE_STD_EXECUTION)
+	const double par_unseq_ms =
+		milliseconds([&]() { parallelUpdate(std::execution::par_unseq, flat, expensive); });
+	std::cout << "  FlatMap with std::execution::par_unseq: " << par_unseq_ms << " ms\n";
+#endif
+}
+
+int main()
+{
+	serial_vs_parallel();
+}
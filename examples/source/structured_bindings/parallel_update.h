@@ -0,0 +1,125 @@
+#pragma once
+
+#include "thread_pool.h"
+
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <span>
+#include <utility>
+#include <vector>
+
+#if defined(HAVE_STD_EXECUTION)
+#include <execution>
+#include <type_traits>
+#endif
+
+/*
+A parallel version of 'update' from structured_bindings.cpp, for when
+computing the new value for a key is expensive.
+
+Every key is independent of the others, so the elements are split into
+chunks and the chunks are updated on a thread pool. There are a few chunks per
+thread, so that a thread that finishes early, or a chunk whose keys happen to
+be expensive, doesn't leave the other threads waiting at the end.
+
+How the container is split depends on how it stores its elements:
+
+- A flat container such as FlatMap has its keys and values in two arrays, and
+  a chunk is a contiguous range of positions. Finding the chunks is free and
+  every thread walks its own part of the arrays.
+- Any other map, such as std::map or SwissMap, is split by walking it once and
+  recording an iterator at every chunk boundary. For std::map it would be
+  nicer to split the tree into subtrees, but the standard doesn't give access
+  to the tree. The walk is one pointer chase per element, cheap compared to
+  calling an expensive function for every element.
+
+The function is called concurrently from several threads, so it must not
+modify shared state without synchronization.
+
+With HAVE_STD_EXECUTION, set by CMake when TBB is found, there is also an
+overload that takes a standard execution policy, such as
+std::execution::par_unseq, and leaves the splitting to the standard library.
+libstdc++ runs the parallel algorithms on TBB, without TBB they run serially.
+*/
+
+/// A map that stores its keys and values in two parallel arrays, like FlatMap.
+template <typename Map>
+concept FlatKeyValueStorage = requires(Map& map) {
+	{ map.keys() } -> std::convertible_to<std::span<const typename Map::key_type>>;
+	{ map.values() } -> std::convertible_to<std::span<typename Map::mapped_type>>;
+};
+
+/// Number of chunks for 'num_elements' elements on 'num_threads' threads.
+inline std::ptrdiff_t numUpdateChunks(std::ptrdiff_t num_elements, int num_threads)
+{
+	constexpr std::ptrdiff_t CHUNKS_PER_THREAD {4};
+	return std::min(num_elements, CHUNKS_PER_THREAD * num_threads);
+}
+
+/// Set the value of every element of 'table' to 'getNewValueForKey(key)', with
+/// the calls spread over the threads of 'pool'. Blocks until all are done.
+template <typename Map, typename Function>
+void parallelUpdate(ThreadPool& pool, Map& table, Function getNewValueForKey)
+{
+	const std::ptrdiff_t size = std::ssize(table);
+	const std::ptrdiff_t num_chunks = numUpdateChunks(size, pool.numThreads());
+
+	if constexpr (FlatKeyValueStorage<Map>)
+	{
+		const auto keys = table.keys();
+		const auto values = table.values();
+		pool.parallelFor(num_chunks, [&](std::ptrdiff_t chunk) {
+			const std::ptrdiff_t first = size * chunk / num_chunks;
+			const std::ptrdiff_t last = size * (chunk + 1) / num_chunks;
+			for (std::ptrdiff_t i = first; i < last; ++i)
+			{
+				const auto index = static_cast<std::size_t>(i);
+				values[index] = getNewValueForKey(keys[index]);
+			}
+		});
+	}
+	else
+	{
+		// Chunk c is [boundaries[c], boundaries[c + 1]).
+		using Iterator = decltype(table.begin());
+		std::vector<Iterator> boundaries;
+		boundaries.reserve(static_cast<std::size_t>(num_chunks + 1));
+		std::ptrdiff_t position {0};
+		for (Iterator it = table.begin(); it != table.end(); ++it, ++position)
+		{
+			if (position == size * std::ssize(boundaries) / num_chunks)
+			{
+				boundaries.push_back(it);
+			}
+		}
+		boundaries.push_back(table.end());
+
+		pool.parallelFor(num_chunks, [&](std::ptrdiff_t chunk) {
+			const Iterator last = boundaries[static_cast<std::size_t>(chunk + 1)];
+			for (Iterator it = boundaries[static_cast<std::size_t>(chunk)]; it != last; ++it)
+			{
+				auto& [key, value] = *it;
+				value = getNewValueForKey(key);
+			}
+		});
+	}
+}
+
+#if defined(HAVE_STD_EXECUTION)
+/// Same as above with a standard execution policy, e.g.
+/// std::execution::par_unseq, instead of a thread pool. Only for flat
+/// containers, the parallel algorithms need at least forward iterators.
+template <typename ExecutionPolicy, typename Map, typename Function>
+	requires std::is_execution_policy_v<std::remove_cvref_t<ExecutionPolicy>> &&
+			 FlatKeyValueStorage<Map>
+void parallelUpdate(ExecutionPolicy&& policy, Map& table, Function getNewValueForKey)
+{
+	const auto keys = table.keys();
+	const auto values = table.values();
+	std::transform(
+		std::forward<ExecutionPolicy>(policy), keys.begin(), keys.end(), values.begin(),
+		getNewValueForKey);
+}
+#endif
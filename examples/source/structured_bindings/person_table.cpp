@@ -0,0 +1,138 @@
+#include "person_table.h"
+#include "string_arena.h"
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+template <typename Function>
+double milliseconds(Function function)
+{
+	const auto start = std::chrono::steady_clock::now();
+	function();
+	const auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+/// The fields of Person in structured_bindings.cpp, stored together.
+struct Person
+{
+	std::uint64_t id;
+	std::string name;
+	std::uint16_t age;
+};
+
+/// Person with the name in a StringArena.
+struct ArenaPerson
+{
+	std::uint64_t id;
+	std::string_view name;
+	std::uint16_t age;
+};
+
+std::string makeName(std::mt19937& random)
+{
+	// Longer than the small string buffer, so every std::string allocates.
+	std::string name = "Person-with-a-long-name-";
+	name += std::to_string(random());
+	return name;
+}
+
+void rows_vs_columns(int num_people)
+{
+	std::cout << "\n# " << __FUNCTION__ << ", " << num_people << " people\n";
+
+	std::vector<Person> rows;
+	std::vector<ArenaPerson> arena_rows;
+	StringArena arena;
+	PersonTable columns;
+
+	std::mt19937 random(1234);
+	std::vector<std::string> names;
+	for (int i = 0; i < num_people; ++i)
+	{
+		names.push_back(makeName(random));
+	}
+	const auto id = [](int i) { return static_cast<std::uint64_t>(i); };
+	const auto name = [&names](int i) { return names[static_cast<std::size_t>(i)]; };
+	const auto age = [](int i) { return static_cast<std::uint16_t>(i % 100); };
+
+	const double rows_load_ms = milliseconds([&]() {
+		rows.reserve(static_cast<std::size_t>(num_people));
+		for (int i = 0; i < num_people; ++i)
+		{
+			rows.push_back({id(i), name(i), age(i)});
+		}
+	});
+	const double arena_load_ms = milliseconds([&]() {
+		arena_rows.reserve(static_cast<std::size_t>(num_people));
+		for (int i = 0; i < num_people; ++i)
+		{
+			arena_rows.push_back({id(i), arena.store(name(i)), age(i)});
+		}
+	});
+	const double columns_load_ms = milliseconds([&]() {
+		for (int i = 0; i < num_people; ++i)
+		{
+			columns.push_back(id(i), name(i), age(i));
+		}
+	});
+
+	// The same scans, over whole records and over single columns.
+	std::uint64_t sums[2] {};
+	const double rows_scan_ms = milliseconds([&]() {
+		for (const Person& person : rows)
+		{
+			sums[0] += person.age;
+		}
+	});
+	const double columns_scan_ms = milliseconds([&]() {
+		const std::span<const std::uint16_t> ages = columns.ages();
+		sums[1] = std::accumulate(ages.begin(), ages.end(), std::uint64_t {0});
+	});
+
+	// Names ending in '7', a scan that has to read the characters.
+	std::ptrdiff_t counts[3] {};
+	const double rows_names_ms = milliseconds([&]() {
+		for (const Person& person : rows)
+		{
+			counts[0] += person.name.ends_with('7');
+		}
+	});
+	const double arena_names_ms = milliseconds([&]() {
+		for (const ArenaPerson& person : arena_rows)
+		{
+			counts[1] += person.name.ends_with('7');
+		}
+	});
+	const double columns_names_ms = milliseconds([&]() {
+		for (std::string_view name : columns.names())
+		{
+			counts[2] += name.ends_with('7');
+		}
+	});
+
+	std::cout << "  Load, Person:                " << rows_load_ms << " ms\n";
+	std::cout << "  Load, ArenaPerson:           " << arena_load_ms << " ms, "
+			  << arena.numBlocks() << " arena blocks\n";
+	std::cout << "  Load, PersonTable:           " << columns_load_ms << " ms\n";
+	std::cout << "  Sum ages, Person:            " << rows_scan_ms << " ms\n";
+	std::cout << "  Sum ages, PersonTable:       " << columns_scan_ms << " ms\n";
+	std::cout << "  Scan names, Person:          " << rows_names_ms << " ms\n";
+	std::cout << "  Scan names, ArenaPerson:     " << arena_names_ms << " ms\n";
+	std::cout << "  Scan names, PersonTable:     " << columns_names_ms << " ms\n";
+	std::cout << "  Same results: " << (sums[0] == sums[1] && counts[0] == counts[1] &&
+										 counts[1] == counts[2])
+			  << '\n';
+}
+
+int main()
+{
+	rows_vs_columns(1'000'000);
+}
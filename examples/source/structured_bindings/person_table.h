@@ -0,0 +1,309 @@
+#pragma once
+
+#include "string_arena.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+/*
+A table of people stored column by column, one array per field.
+
+An array of Person, as in structured_bindings.cpp, stores the id, name, and
+age of each person together. A scan over the ages then loads whole Person
+objects, 48 bytes each with a std::string, to use two of those bytes, and the
+loads are too far apart to vectorize well. Here the ages are a
+std::vector<std::uint16_t> of their own, so an age scan reads 2 bytes per
+person, 32 people per cache line, and is a plain loop over an array.
+
+The names are not std::string, which would allocate each name longer than the
+small string buffer separately, somewhere on the heap. The characters are
+stored in a StringArena, in large blocks one name after the other, and the
+name column holds std::string_view into the arena. Loading people allocates a
+block now and then, not once per name, and a scan over the names in order
+reads the arena sequentially. Changing a name stores the new name, the old
+characters stay in the arena unused.
+
+Rows are read and written through a PersonRow, a proxy with references into
+the id and age columns and a view of the name. It is tuple-like through
+std::tuple_size and get<I>, just like Person, so
+
+	auto [id, name, age] = table[i];
+
+makes 'id' and 'age' references into the columns. That is 'auto' and not
+'auto&' because table[i] returns a temporary proxy, which 'auto&' can't bind
+to, but the bindings are references either way since the proxy's tuple
+elements are. Iteration stashes the proxy in the iterator, like FlatMap, so
+
+	for (auto& [id, name, age] : table)
+
+works as well.
+*/
+
+template <bool Const>
+class PersonRow
+{
+public:
+	using Id = std::conditional_t<Const, const std::uint64_t, std::uint64_t>;
+	using Age = std::conditional_t<Const, const std::uint16_t, std::uint16_t>;
+
+	PersonRow(Id& id, std::string_view name, Age& age)
+		: m_id(id)
+		, m_name(name)
+		, m_age(age)
+	{
+	}
+
+	Id& getId() const
+	{
+		return m_id;
+	}
+
+	/// A view into the table's name arena. Use PersonTable::setName to change it.
+	std::string_view getName() const
+	{
+		return m_name;
+	}
+
+	Age& getAge() const
+	{
+		return m_age;
+	}
+
+private:
+	Id& m_id;
+	std::string_view m_name;
+	Age& m_age;
+};
+
+template <std::size_t I, bool Const>
+decltype(auto) get(const PersonRow<Const>& row)
+{
+	static_assert(I <= 2);
+
+	// decltype(auto) instead of auto& since the name is returned by value.
+	if constexpr (I == 0)
+	{
+		return row.getId();
+	}
+	else if constexpr (I == 1)
+	{
+		return row.getName();
+	}
+	else if constexpr (I == 2)
+	{
+		return row.getAge();
+	}
+}
+
+template <bool Const>
+struct std::tuple_size<PersonRow<Const>> : std::integral_constant<std::size_t, 3>
+{
+};
+
+template <bool Const>
+struct std::tuple_element<0, PersonRow<Const>>
+{
+	using type = typename PersonRow<Const>::Id&;
+};
+
+template <bool Const>
+struct std::tuple_element<1, PersonRow<Const>>
+{
+	using type = std::string_view;
+};
+
+template <bool Const>
+struct std::tuple_element<2, PersonRow<Const>>
+{
+	using type = typename PersonRow<Const>::Age&;
+};
+
+class PersonTable
+{
+public:
+	using Row = PersonRow<false>;
+	using ConstRow = PersonRow<true>;
+
+	template <bool Const>
+	class Iterator;
+
+	using iterator = Iterator<false>;
+	using const_iterator = Iterator<true>;
+
+	std::ptrdiff_t size() const
+	{
+		return std::ssize(m_ids);
+	}
+
+	bool empty() const
+	{
+		return m_ids.empty();
+	}
+
+	/// Make room for 'num_people' people with 'num_name_chars' name characters
+	/// in total.
+	void reserve(std::ptrdiff_t num_people, std::ptrdiff_t num_name_chars)
+	{
+		const auto count = static_cast<std::size_t>(num_people);
+		m_ids.reserve(count);
+		m_ages.reserve(count);
+		m_names.reserve(count);
+		m_name_arena.reserve(num_name_chars);
+	}
+
+	void push_back(std::uint64_t id, std::string_view name, std::uint16_t age)
+	{
+		m_ids.push_back(id);
+		m_ages.push_back(age);
+		m_names.push_back(m_name_arena.store(name));
+	}
+
+	Row operator[](std::ptrdiff_t index)
+	{
+		const auto i = static_cast<std::size_t>(index);
+		return Row(m_ids[i], m_names[i], m_ages[i]);
+	}
+
+	ConstRow operator[](std::ptrdiff_t index) const
+	{
+		const auto i = static_cast<std::size_t>(index);
+		return ConstRow(m_ids[i], m_names[i], m_ages[i]);
+	}
+
+	/// Rows and views of the previous name stay valid, the old name isn't
+	/// freed until the table is destroyed.
+	void setName(std::ptrdiff_t index, std::string_view name)
+	{
+		m_names[static_cast<std::size_t>(index)] = m_name_arena.store(name);
+	}
+
+	/// The columns, for scans that only need one field.
+	std::span<std::uint64_t> ids()
+	{
+		return m_ids;
+	}
+
+	std::span<const std::uint64_t> ids() const
+	{
+		return m_ids;
+	}
+
+	std::span<std::uint16_t> ages()
+	{
+		return m_ages;
+	}
+
+	std::span<const std::uint16_t> ages() const
+	{
+		return m_ages;
+	}
+
+	std::span<const std::string_view> names() const
+	{
+		return m_names;
+	}
+
+	iterator begin()
+	{
+		return iterator(this, 0);
+	}
+
+	iterator end()
+	{
+		return iterator(this, size());
+	}
+
+	const_iterator begin() const
+	{
+		return const_iterator(this, 0);
+	}
+
+	const_iterator end() const
+	{
+		return const_iterator(this, size());
+	}
+
+	template <bool Const>
+	class Iterator
+	{
+	public:
+		using Table = std::conditional_t<Const, const PersonTable, PersonTable>;
+		using value_type = PersonRow<Const>;
+		using reference = value_type&;
+		using pointer = value_type*;
+		using difference_type = std::ptrdiff_t;
+		using iterator_category = std::input_iterator_tag;
+
+		Iterator() = default;
+
+		Iterator(Table* table, std::ptrdiff_t index)
+			: m_table(table)
+			, m_index(index)
+		{
+		}
+
+		// The stashed row holds references and can't be reassigned, so
+		// copies start without one and the next operator* builds it again.
+		Iterator(const Iterator& other)
+			: m_table(other.m_table)
+			, m_index(other.m_index)
+		{
+		}
+
+		Iterator& operator=(const Iterator& other)
+		{
+			m_table = other.m_table;
+			m_index = other.m_index;
+			m_row.reset();
+			return *this;
+		}
+
+		reference operator*() const
+		{
+			m_row.emplace((*m_table)[m_index]);
+			return *m_row;
+		}
+
+		pointer operator->() const
+		{
+			return &**this;
+		}
+
+		Iterator& operator++()
+		{
+			++m_index;
+			return *this;
+		}
+
+		Iterator operator++(int)
+		{
+			Iterator previous = *this;
+			++m_index;
+			return previous;
+		}
+
+		friend bool operator==(const Iterator& lhs, const Iterator& rhs)
+		{
+			return lhs.m_index == rhs.m_index;
+		}
+
+	private:
+		Table* m_table {nullptr};
+		std::ptrdiff_t m_index {0};
+		mutable std::optional<value_type> m_row;
+	};
+
+private:
+	std::vector<std::uint64_t> m_ids;
+	std::vector<std::uint16_t> m_ages;
+	std::vector<std::string_view> m_names;
+	StringArena m_name_arena;
+};
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+/*
+Append-only storage for many small strings, handed out as std::string_view.
+
+Every std::string longer than its small string buffer, 15 characters in
+libstdc++, is a separate heap allocation, and a million names are a million
+allocations scattered over the heap. The arena instead copies the characters
+into large blocks, one after the other, and returns a view of the copy. Loading
+a million names is a handful of allocations, or one after 'reserve', and the
+names stored one after the other are next to each other in memory, so a scan
+over them in that order reads memory sequentially.
+
+This is the idea of std::pmr::monotonic_buffer_resource, see
+"CppCon 2021 - Real-Time Programming With The C++ Standard Library.md",
+specialized for characters. Blocks are never moved or freed, a full block is
+left as is and a new, twice as large block is started, so every view stays
+valid until the arena is cleared or destroyed. Strings can't be freed
+individually either. Replacing a string stores the new one and leaves the old
+characters unused.
+
+The views don't own anything, see "String View.md". Whatever holds them must
+not outlive the arena.
+*/
+
+class StringArena
+{
+public:
+	static constexpr std::ptrdiff_t FIRST_BLOCK_SIZE {4096};
+
+	StringArena() = default;
+
+	StringArena(StringArena&&) noexcept = default;
+	StringArena& operator=(StringArena&&) noexcept = default;
+
+	StringArena(const StringArena&) = delete;
+	StringArena& operator=(const StringArena&) = delete;
+
+	/// Copy 'text' into the arena. The view is valid until the arena is
+	/// cleared or destroyed.
+	std::string_view store(std::string_view text)
+	{
+		const auto size = std::ssize(text);
+		if (size == 0)
+		{
+			return {};
+		}
+		if (size > m_block_size - m_block_used)
+		{
+			startBlock(std::max(size, 2 * m_block_size));
+		}
+		char* copy = m_blocks.back().get() + m_block_used;
+		std::memcpy(copy, text.data(), static_cast<std::size_t>(size));
+		m_block_used += size;
+		m_num_chars += size;
+		return std::string_view(copy, static_cast<std::size_t>(size));
+	}
+
+	/// Make room for 'num_chars' more characters in the current block, so
+	/// that storing that many allocates nothing.
+	void reserve(std::ptrdiff_t num_chars)
+	{
+		if (num_chars > m_block_size - m_block_used)
+		{
+			startBlock(num_chars);
+		}
+	}
+
+	/// Invalidates every view returned by 'store'.
+	void clear()
+	{
+		m_blocks.clear();
+		m_block_size = 0;
+		m_block_used = 0;
+		m_num_chars = 0;
+	}
+
+	/// Total length of all stored strings.
+	std::ptrdiff_t numChars() const
+	{
+		return m_num_chars;
+	}
+
+	/// Number of allocations made, one per block.
+	std::ptrdiff_t numBlocks() const
+	{
+		return std::ssize(m_blocks);
+	}
+
+private:
+	void startBlock(std::ptrdiff_t size)
+	{
+		size = std::max(size, FIRST_BLOCK_SIZE);
+		m_blocks.push_back(std::make_unique_for_overwrite<char[]>(static_cast<std::size_t>(size)));
+		m_block_size = size;
+		m_block_used = 0;
+	}
+
+private:
+	std::vector<std::unique_ptr<char[]>> m_blocks;
+	/// Size and used part of the last block, the only one still filled.
+	std::ptrdiff_t m_block_size {0};
+	std::ptrdiff_t m_block_used {0};
+	std::ptrdiff_t m_num_chars {0};
+};
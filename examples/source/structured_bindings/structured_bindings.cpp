@@ -1,9 +1,15 @@
+#include "flat_map.h"
+#include "person_table.h"
+#include "swiss_map.h"
+
 #include <cstdint>
 #include <iostream>
 #include <map>
 
-template <typename Key, typename Value, typename Function>
-void update(std::map<Key, Value>& table, Function getNewValueForKey)
+// Works with any map whose elements destructure into a key and a value, such
+// as std::map, FlatMap, and SwissMap.
+template <typename Map, typename Function>
+void update(Map& table, Function getNewValueForKey)
 {
 	for (auto& [key, value] : table)
 	{
@@ -39,6 +45,35 @@ void testUpdate()
 	print(table);
 }
 
+void testFlatMap()
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	// Keys and values in separate arrays, same iteration as std::map.
+	FlatMap<int, char> table {{3, 'c'}, {1, 'a'}, {2, 'b'}};
+
+	print(table);
+	std::cout << "Make upper-case.\n";
+	update(table, [](int key) { return 'A' + key - 1; });
+	print(table);
+}
+
+void testSwissMap()
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	// Open addressing, same iteration as std::map but in no particular order.
+	SwissMap<int, char> table;
+	table.insert(1, 'a');
+	table.insert(2, 'b');
+	table.insert(3, 'c');
+
+	print(table);
+	std::cout << "Make upper-case.\n";
+	update(table, [](int key) { return 'A' + key - 1; });
+	print(table);
+}
+
 class Person
 {
 public:
@@ -115,8 +150,32 @@ void testPerson()
 #endif
 }
 
+void testPersonTable()
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	// One column per field, but rows destructure just like a Person.
+	PersonTable table;
+	table.push_back(0, "Alice", 18);
+	table.push_back(1, "Bob", 42);
+
+	// 'auto' since table[1] is a temporary row, but 'bob_age' is a reference
+	// into the age column.
+	auto [bob_id, bob_name, bob_age] = table[1];
+	bob_age += 1;
+	std::cout << bob_id << ", " << bob_name << ", " << get<2>(table[1]) << '\n';
+
+	for (auto& [id, name, age] : table)
+	{
+		std::cout << id << ", " << name << ", " << age << '\n';
+	}
+}
+
 int main()
 {
 	testUpdate();
+	testFlatMap();
+	testSwissMap();
 	testPerson();
+	testPersonTable();
 }
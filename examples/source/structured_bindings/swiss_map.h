@@ -0,0 +1,597 @@
+#pragma once
+
+#include <bit>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/*
+A hash map with open addressing in the style of Abseil's SwissTable.
+
+std::unordered_map allocates a node per element and chains the nodes of a
+bucket in a linked list, so a lookup is a hash, a bucket load, and one pointer
+chase per element in the chain. Open addressing stores the elements directly
+in the table and, on a collision, probes other slots of the same table. See
+"For hash maps, prefer open addressing" in
+"CppCon 2022 - Introduction To Hardware Efficiency In CPP.md".
+
+The SwissTable twist is a separate array of one control byte per slot. A
+control byte is either EMPTY, DELETED, or, for a full slot, the low 7 bits of
+the key's hash, called H2. The slots are divided into groups of 16, and a
+lookup compares H2 against all 16 control bytes of a group at once with SSE2.
+Only slots whose control byte matches, on average far less than one per group
+for a miss, have their key compared. The rest of the hash, H1, picks the group
+to start in, and a group that has an EMPTY slot ends the probe.
+
+Keys, values, and control bytes are in three separate arrays. Probing touches
+only control bytes and keys, iterating over values touches only values.
+
+Erasing marks a slot DELETED instead of EMPTY when the group is full, since
+other keys may have probed past this group. A group with an EMPTY slot has had
+one since the last rehash, so no key has probed past it and the slot can go
+straight back to EMPTY.
+
+Iteration produces a MapElement, a tuple-like pair of references into the key
+and value arrays, so that
+
+	for (auto& [key, value] : table)
+
+works just as for a std::map, through std::tuple_size and get<I> like Person
+in structured_bindings.cpp. The element lives in the iterator, so the
+iterators are enough for range-based for loops and the simpler algorithms but
+aren't proper forward iterators.
+*/
+
+/// The key and value of one element, as references into the map.
+template <typename Key, typename Value>
+struct MapElement
+{
+	const Key& first;
+	Value& second;
+};
+
+template <std::size_t I, typename Key, typename Value>
+auto& get(const MapElement<Key, Value>& element)
+{
+	static_assert(I <= 1);
+
+	if constexpr (I == 0)
+	{
+		return element.first;
+	}
+	else if constexpr (I == 1)
+	{
+		return element.second;
+	}
+}
+
+template <typename Key, typename Value>
+struct std::tuple_size<MapElement<Key, Value>> : std::integral_constant<std::size_t, 2>
+{
+};
+
+template <typename Key, typename Value>
+struct std::tuple_element<0, MapElement<Key, Value>>
+{
+	using type = const Key&;
+};
+
+template <typename Key, typename Value>
+struct std::tuple_element<1, MapElement<Key, Value>>
+{
+	using type = Value&;
+};
+
+template <
+	typename Key, typename Value, typename Hash = std::hash<Key>,
+	typename Equal = std::equal_to<Key>>
+class SwissMap
+{
+	// Rehashing moves every element, a throwing move would leave elements
+	// split between the old and the new arrays.
+	static_assert(
+		std::is_nothrow_move_constructible_v<Key> && std::is_nothrow_move_constructible_v<Value>,
+		"SwissMap requires keys and values that can be moved without throwing.");
+
+public:
+	using key_type = Key;
+	using mapped_type = Value;
+
+	static constexpr std::ptrdiff_t GROUP_SIZE {16};
+
+	template <bool Const>
+	class Iterator;
+
+	using iterator = Iterator<false>;
+	using const_iterator = Iterator<true>;
+
+	SwissMap() = default;
+
+	~SwissMap()
+	{
+		destroyAll();
+		deallocate();
+	}
+
+	SwissMap(SwissMap&& other) noexcept
+	{
+		swap(other);
+	}
+
+	SwissMap& operator=(SwissMap&& other) noexcept
+	{
+		SwissMap(std::move(other)).swap(*this);
+		return *this;
+	}
+
+	SwissMap(const SwissMap&) = delete;
+	SwissMap& operator=(const SwissMap&) = delete;
+
+	void swap(SwissMap& other) noexcept
+	{
+		std::swap(m_controls, other.m_controls);
+		std::swap(m_keys, other.m_keys);
+		std::swap(m_values, other.m_values);
+		std::swap(m_capacity, other.m_capacity);
+		std::swap(m_size, other.m_size);
+		std::swap(m_growth_left, other.m_growth_left);
+	}
+
+	std::ptrdiff_t size() const
+	{
+		return m_size;
+	}
+
+	bool empty() const
+	{
+		return m_size == 0;
+	}
+
+	/// Number of slots, a power of two and a multiple of GROUP_SIZE.
+	std::ptrdiff_t capacity() const
+	{
+		return m_capacity;
+	}
+
+	/// Make room for 'count' elements without rehashing.
+	void reserve(std::ptrdiff_t count)
+	{
+		if (count > m_size + m_growth_left)
+		{
+			rehash(capacityFor(count));
+		}
+	}
+
+	void clear()
+	{
+		destroyAll();
+		if (m_capacity > 0)
+		{
+			std::memset(m_controls, EMPTY, static_cast<std::size_t>(m_capacity));
+		}
+		m_size = 0;
+		m_growth_left = maxLoad(m_capacity);
+	}
+
+	/// Insert 'key' with 'value' unless 'key' is already present. Returns the
+	/// element with 'key' and whether it was inserted.
+	std::pair<iterator, bool> insert(Key key, Value value)
+	{
+		const std::size_t hash = hashOf(key);
+		if (const std::ptrdiff_t slot = findSlot(key, hash); slot != m_capacity)
+		{
+			return {iterator(this, slot), false};
+		}
+
+		if (m_capacity == 0)
+		{
+			rehash(GROUP_SIZE);
+		}
+		std::ptrdiff_t slot = findInsertSlot(hash);
+		if (m_growth_left == 0 && m_controls[slot] == EMPTY)
+		{
+			// Out of EMPTY slots. If most of the used up ones are DELETED, a rehash
+			// at the same capacity clears them, otherwise grow.
+			rehash(m_size < maxLoad(m_capacity) / 2 ? m_capacity : m_capacity * 2);
+			slot = findInsertSlot(hash);
+		}
+		if (m_controls[slot] == EMPTY)
+		{
+			--m_growth_left;
+		}
+		std::construct_at(m_keys + slot, std::move(key));
+		std::construct_at(m_values + slot, std::move(value));
+		m_controls[slot] = h2(hash);
+		++m_size;
+		return {iterator(this, slot), true};
+	}
+
+	Value& operator[](const Key& key)
+	{
+		if (const std::ptrdiff_t slot = findSlot(key, hashOf(key)); slot != m_capacity)
+		{
+			return m_values[slot];
+		}
+		return insert(key, Value {}).first->second;
+	}
+
+	/// Remove the element with 'key'. Returns the number of elements removed.
+	std::ptrdiff_t erase(const Key& key)
+	{
+		const std::ptrdiff_t slot = findSlot(key, hashOf(key));
+		if (slot == m_capacity)
+		{
+			return 0;
+		}
+		std::destroy_at(m_keys + slot);
+		std::destroy_at(m_values + slot);
+		if (matchEmpty(slot / GROUP_SIZE) != 0)
+		{
+			m_controls[slot] = EMPTY;
+			++m_growth_left;
+		}
+		else
+		{
+			m_controls[slot] = DELETED;
+		}
+		--m_size;
+		return 1;
+	}
+
+	iterator find(const Key& key)
+	{
+		return iterator(this, findSlot(key, hashOf(key)));
+	}
+
+	const_iterator find(const Key& key) const
+	{
+		return const_iterator(this, findSlot(key, hashOf(key)));
+	}
+
+	bool contains(const Key& key) const
+	{
+		return findSlot(key, hashOf(key)) != m_capacity;
+	}
+
+	Value& at(const Key& key)
+	{
+		const std::ptrdiff_t slot = findSlot(key, hashOf(key));
+		if (slot == m_capacity)
+		{
+			throw std::out_of_range("SwissMap::at: key not found.");
+		}
+		return m_values[slot];
+	}
+
+	const Value& at(const Key& key) const
+	{
+		return const_cast<SwissMap&>(*this).at(key);
+	}
+
+	iterator begin()
+	{
+		return iterator(this, nextFull(0));
+	}
+
+	iterator end()
+	{
+		return iterator(this, m_capacity);
+	}
+
+	const_iterator begin() const
+	{
+		return const_iterator(this, nextFull(0));
+	}
+
+	const_iterator end() const
+	{
+		return const_iterator(this, m_capacity);
+	}
+
+	template <bool Const>
+	class Iterator
+	{
+	public:
+		using Map = std::conditional_t<Const, const SwissMap, SwissMap>;
+		using value_type = MapElement<Key, std::conditional_t<Const, const Value, Value>>;
+		using reference = value_type&;
+		using pointer = value_type*;
+		using difference_type = std::ptrdiff_t;
+		using iterator_category = std::input_iterator_tag;
+
+		Iterator() = default;
+
+		Iterator(Map* map, std::ptrdiff_t slot)
+			: m_map(map)
+			, m_slot(slot)
+		{
+		}
+
+		// The stashed element holds references and can't be reassigned, so
+		// copies start without one and the next operator* builds it again.
+		Iterator(const Iterator& other)
+			: m_map(other.m_map)
+			, m_slot(other.m_slot)
+		{
+		}
+
+		Iterator& operator=(const Iterator& other)
+		{
+			m_map = other.m_map;
+			m_slot = other.m_slot;
+			m_element.reset();
+			return *this;
+		}
+
+		reference operator*() const
+		{
+			m_element.emplace(value_type {m_map->m_keys[m_slot], m_map->m_values[m_slot]});
+			return *m_element;
+		}
+
+		pointer operator->() const
+		{
+			return &**this;
+		}
+
+		Iterator& operator++()
+		{
+			m_slot = m_map->nextFull(m_slot + 1);
+			return *this;
+		}
+
+		Iterator operator++(int)
+		{
+			Iterator previous = *this;
+			++*this;
+			return previous;
+		}
+
+		friend bool operator==(const Iterator& lhs, const Iterator& rhs)
+		{
+			return lhs.m_slot == rhs.m_slot;
+		}
+
+	private:
+		Map* m_map {nullptr};
+		std::ptrdiff_t m_slot {0};
+		mutable std::optional<value_type> m_element;
+	};
+
+private:
+	static constexpr std::int8_t EMPTY {-128};
+	static constexpr std::int8_t DELETED {-2};
+
+	/// A bit mask with bit i set for every slot i of a group that matches.
+	using Mask = std::uint32_t;
+
+	/// At most 7/8 of the slots are full, beyond that probe sequences get long.
+	static std::ptrdiff_t maxLoad(std::ptrdiff_t capacity)
+	{
+		return capacity - capacity / 8;
+	}
+
+	static std::ptrdiff_t capacityFor(std::ptrdiff_t count)
+	{
+		std::ptrdiff_t capacity {GROUP_SIZE};
+		while (maxLoad(capacity) < count)
+		{
+			capacity *= 2;
+		}
+		return capacity;
+	}
+
+	std::size_t hashOf(const Key& key) const
+	{
+		// std::hash of an integer is the integer itself, mix the bits so that
+		// both H1 and H2 depend on all of them.
+		const std::uint64_t hash = static_cast<std::uint64_t>(Hash {}(key));
+		const unsigned __int128 product =
+			static_cast<unsigned __int128>(hash) * 0x9E37'79B9'7F4A'7C15ULL;
+		return static_cast<std::size_t>(product ^ (product >> 64));
+	}
+
+	static std::int8_t h2(std::size_t hash)
+	{
+		return static_cast<std::int8_t>(hash & 0x7F);
+	}
+
+	static std::size_t h1(std::size_t hash)
+	{
+		return hash >> 7;
+	}
+
+	Mask match(std::ptrdiff_t group, std::int8_t control) const
+	{
+#if defined(__SSE2__)
+		const __m128i controls =
+			_mm_load_si128(reinterpret_cast<const __m128i*>(m_controls + group * GROUP_SIZE));
+		const __m128i matches = _mm_cmpeq_epi8(controls, _mm_set1_epi8(control));
+		return static_cast<Mask>(_mm_movemask_epi8(matches));
+#else
+		Mask mask {0};
+		for (std::ptrdiff_t i = 0; i < GROUP_SIZE; ++i)
+		{
+			mask |= Mask {m_controls[group * GROUP_SIZE + i] == control} << i;
+		}
+		return mask;
+#endif
+	}
+
+	Mask matchEmpty(std::ptrdiff_t group) const
+	{
+		return match(group, EMPTY);
+	}
+
+	/// EMPTY and DELETED are the control bytes with the sign bit set.
+	Mask matchEmptyOrDeleted(std::ptrdiff_t group) const
+	{
+#if defined(__SSE2__)
+		const __m128i controls =
+			_mm_load_si128(reinterpret_cast<const __m128i*>(m_controls + group * GROUP_SIZE));
+		return static_cast<Mask>(_mm_movemask_epi8(controls));
+#else
+		Mask mask {0};
+		for (std::ptrdiff_t i = 0; i < GROUP_SIZE; ++i)
+		{
+			mask |= Mask {m_controls[group * GROUP_SIZE + i] < 0} << i;
+		}
+		return mask;
+#endif
+	}
+
+	/// The slot holding 'key', or m_capacity if there is none.
+	std::ptrdiff_t findSlot(const Key& key, std::size_t hash) const
+	{
+		if (m_capacity == 0)
+		{
+			return m_capacity;
+		}
+		const std::ptrdiff_t num_groups = m_capacity / GROUP_SIZE;
+		std::ptrdiff_t group = static_cast<std::ptrdiff_t>(h1(hash)) & (num_groups - 1);
+		// Triangular probing, group + 1, + 2, + 3, ..., visits every group once
+		// when the number of groups is a power of two.
+		for (std::ptrdiff_t step = 1; step <= num_groups; ++step)
+		{
+			Mask candidates = match(group, h2(hash));
+			for (; candidates != 0; candidates &= candidates - 1)
+			{
+				const std::ptrdiff_t slot = group * GROUP_SIZE + std::countr_zero(candidates);
+				if (Equal {}(m_keys[slot], key))
+				{
+					return slot;
+				}
+			}
+			if (matchEmpty(group) != 0)
+			{
+				return m_capacity;
+			}
+			group = (group + step) & (num_groups - 1);
+		}
+		return m_capacity;
+	}
+
+	/// The first EMPTY or DELETED slot on the probe sequence for 'hash'.
+	std::ptrdiff_t findInsertSlot(std::size_t hash) const
+	{
+		const std::ptrdiff_t num_groups = m_capacity / GROUP_SIZE;
+		std::ptrdiff_t group = static_cast<std::ptrdiff_t>(h1(hash)) & (num_groups - 1);
+		for (std::ptrdiff_t step = 1;; ++step)
+		{
+			if (const Mask free = matchEmptyOrDeleted(group); free != 0)
+			{
+				return group * GROUP_SIZE + std::countr_zero(free);
+			}
+			group = (group + step) & (num_groups - 1);
+		}
+	}
+
+	std::ptrdiff_t nextFull(std::ptrdiff_t slot) const
+	{
+		while (slot < m_capacity && m_controls[slot] < 0)
+		{
+			++slot;
+		}
+		return slot;
+	}
+
+	/// Move every element into new arrays of 'new_capacity' slots. If an
+	/// allocation fails the map is unchanged. If Hash throws, the map keeps all
+	/// its elements, but those already moved are left with moved-from values.
+	void rehash(std::ptrdiff_t new_capacity)
+	{
+		SwissMap rehashed;
+		rehashed.allocate(new_capacity);
+
+		for (std::ptrdiff_t slot = nextFull(0); slot < m_capacity; slot = nextFull(slot + 1))
+		{
+			const std::size_t hash = hashOf(m_keys[slot]);
+			const std::ptrdiff_t new_slot = rehashed.findInsertSlot(hash);
+			std::construct_at(rehashed.m_keys + new_slot, std::move(m_keys[slot]));
+			std::construct_at(rehashed.m_values + new_slot, std::move(m_values[slot]));
+			rehashed.m_controls[new_slot] = h2(hash);
+			--rehashed.m_growth_left;
+			++rehashed.m_size;
+		}
+		// The moved-from elements are destroyed with 'rehashed'.
+		swap(rehashed);
+	}
+
+	/// Allocate all three arrays for an empty map. Nothing is committed to the
+	/// members until all allocations have succeeded.
+	void allocate(std::ptrdiff_t capacity)
+	{
+		const auto num_slots = static_cast<std::size_t>(capacity);
+		std::unique_ptr<std::int8_t, ControlsDelete> controls(
+			static_cast<std::int8_t*>(::operator new(num_slots, std::align_val_t {16})));
+		Key* keys = std::allocator<Key>().allocate(num_slots);
+		Value* values {nullptr};
+		try
+		{
+			values = std::allocator<Value>().allocate(num_slots);
+		}
+		catch (...)
+		{
+			std::allocator<Key>().deallocate(keys, num_slots);
+			throw;
+		}
+		std::memset(controls.get(), EMPTY, num_slots);
+		m_controls = controls.release();
+		m_keys = keys;
+		m_values = values;
+		m_capacity = capacity;
+		m_growth_left = maxLoad(capacity);
+	}
+
+	struct ControlsDelete
+	{
+		void operator()(std::int8_t* controls) const
+		{
+			::operator delete(controls, std::align_val_t {16});
+		}
+	};
+
+	void destroyAll()
+	{
+		for (std::ptrdiff_t slot = nextFull(0); slot < m_capacity; slot = nextFull(slot + 1))
+		{
+			std::destroy_at(m_keys + slot);
+			std::destroy_at(m_values + slot);
+			m_controls[slot] = EMPTY;
+		}
+	}
+
+	void deallocate()
+	{
+		if (m_capacity > 0)
+		{
+			const auto num_slots = static_cast<std::size_t>(m_capacity);
+			::operator delete(m_controls, std::align_val_t {16});
+			std::allocator<Key>().deallocate(m_keys, num_slots);
+			std::allocator<Value>().deallocate(m_values, num_slots);
+		}
+	}
+
+private:
+	std::int8_t* m_controls {nullptr};
+	Key* m_keys {nullptr};
+	Value* m_values {nullptr};
+	std::ptrdiff_t m_capacity {0};
+	std::ptrdiff_t m_size {0};
+	/// Number of EMPTY slots that may still be filled before a rehash.
+	std::ptrdiff_t m_growth_left {0};
+};
@@ -0,0 +1,172 @@
+/*
+Compares lookups in std::map, std::unordered_map, and SwissMap from 1K to 10M
+keys, from tables that fit in L1 to tables far larger than the last-level
+cache. Hit looks up keys that are in the map, Miss keys that aren't. Insert
+builds the map from scratch with the keys in random order, without reserving.
+
+The keys are random 64-bit integers, the values their position. Every lookup
+loop goes through the same 64K random keys, so the time per iteration is
+comparable between sizes.
+
+Build in Release mode, the comparison is meaningless without optimization:
+  cmake -S . -B build -DCMAKE_BUILD_TYPE=Release
+  cmake --build build --target swiss_map_bench
+
+Run a subset, e.g. only the misses:
+  ./build/structured_bindings/swiss_map_bench --benchmark_filter=Miss
+*/
+
+#include "swiss_map.h"
+
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <map>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+constexpr int NUM_LOOKUPS {1 << 16};
+
+/// 'count' distinct random keys. Odd keys are in the maps, even keys are misses.
+std::vector<std::uint64_t> makeKeys(std::int64_t count, bool odd)
+{
+	std::mt19937_64 random(static_cast<std::uint64_t>(count));
+	std::vector<std::uint64_t> keys;
+	keys.reserve(static_cast<std::size_t>(count));
+	for (std::int64_t i = 0; i < count; ++i)
+	{
+		keys.push_back((random() & ~std::uint64_t {1}) | std::uint64_t {odd});
+	}
+	return keys;
+}
+
+template <typename Map>
+Map makeMap(const std::vector<std::uint64_t>& keys)
+{
+	Map map;
+	for (std::size_t i = 0; i < keys.size(); ++i)
+	{
+		map[keys[i]] = i;
+	}
+	return map;
+}
+
+/// NUM_LOOKUPS keys picked at random from 'keys'.
+std::vector<std::uint64_t> pickLookups(const std::vector<std::uint64_t>& keys)
+{
+	std::mt19937_64 random(42);
+	std::vector<std::uint64_t> lookups;
+	lookups.reserve(NUM_LOOKUPS);
+	for (int i = 0; i < NUM_LOOKUPS; ++i)
+	{
+		lookups.push_back(keys[random() % keys.size()]);
+	}
+	return lookups;
+}
+
+template <typename Map>
+void lookup(benchmark::State& state, bool hit)
+{
+	const std::vector<std::uint64_t> keys = makeKeys(state.range(0), true);
+	const Map map = makeMap<Map>(keys);
+	const std::vector<std::uint64_t> lookups =
+		pickLookups(hit ? keys : makeKeys(state.range(0), false));
+
+	for (auto _ : state)
+	{
+		std::uint64_t sum {0};
+		for (std::uint64_t key : lookups)
+		{
+			if (auto it = map.find(key); it != map.end())
+			{
+				sum += it->second;
+			}
+		}
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetItemsProcessed(state.iterations() * NUM_LOOKUPS);
+}
+
+template <typename Map>
+void insert(benchmark::State& state)
+{
+	const std::vector<std::uint64_t> keys = makeKeys(state.range(0), true);
+
+	for (auto _ : state)
+	{
+		Map map = makeMap<Map>(keys);
+		benchmark::DoNotOptimize(map);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+using StdMap = std::map<std::uint64_t, std::uint64_t>;
+using StdUnorderedMap = std::unordered_map<std::uint64_t, std::uint64_t>;
+using Swiss = SwissMap<std::uint64_t, std::uint64_t>;
+
+static void BM_Hit_StdMap(benchmark::State& state)
+{
+	lookup<StdMap>(state, true);
+}
+
+static void BM_Hit_StdUnorderedMap(benchmark::State& state)
+{
+	lookup<StdUnorderedMap>(state, true);
+}
+
+static void BM_Hit_SwissMap(benchmark::State& state)
+{
+	lookup<Swiss>(state, true);
+}
+
+static void BM_Miss_StdMap(benchmark::State& state)
+{
+	lookup<StdMap>(state, false);
+}
+
+static void BM_Miss_StdUnorderedMap(benchmark::State& state)
+{
+	lookup<StdUnorderedMap>(state, false);
+}
+
+static void BM_Miss_SwissMap(benchmark::State& state)
+{
+	lookup<Swiss>(state, false);
+}
+
+static void BM_Insert_StdMap(benchmark::State& state)
+{
+	insert<StdMap>(state);
+}
+
+static void BM_Insert_StdUnorderedMap(benchmark::State& state)
+{
+	insert<StdUnorderedMap>(state);
+}
+
+static void BM_Insert_SwissMap(benchmark::State& state)
+{
+	insert<Swiss>(state);
+}
+
+static void sizes(benchmark::internal::Benchmark* benchmark)
+{
+	for (std::int64_t num_keys = 1'000; num_keys <= 10'000'000; num_keys *= 10)
+	{
+		benchmark->Arg(num_keys);
+	}
+	benchmark->Unit(benchmark::kMicrosecond);
+}
+
+BENCHMARK(BM_Hit_StdMap)->Apply(sizes);
+BENCHMARK(BM_Hit_StdUnorderedMap)->Apply(sizes);
+BENCHMARK(BM_Hit_SwissMap)->Apply(sizes);
+BENCHMARK(BM_Miss_StdMap)->Apply(sizes);
+BENCHMARK(BM_Miss_StdUnorderedMap)->Apply(sizes);
+BENCHMARK(BM_Miss_SwissMap)->Apply(sizes);
+BENCHMARK(BM_Insert_StdMap)->Apply(sizes);
+BENCHMARK(BM_Insert_StdUnorderedMap)->Apply(sizes);
+BENCHMARK(BM_Insert_SwissMap)->Apply(sizes);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,127 @@
+#include "compact_variant_vector.h"
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <variant>
+#include <vector>
+
+using IntOrDouble = std::variant<int, double>;
+using IntOrDoubles = std::vector<IntOrDouble>;
+
+template <typename Function>
+double milliseconds(Function function)
+{
+	const auto start = std::chrono::steady_clock::now();
+	function();
+	const auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+void same_elements_as_variant_cpp()
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	std::cout << "  sizeof(IntOrDouble) = " << sizeof(IntOrDouble) << '\n';
+	std::cout << "  sizeof(NaNBox)      = " << sizeof(NaNBox) << '\n';
+
+	CompactVariantVector<int, double> int_or_doubles;
+	for (IntOrDouble value : IntOrDoubles {1, 2.0, 3, 4.0, 5, 6, 7, 8.0})
+	{
+		int_or_doubles.push_back(value);
+	}
+
+	std::cout << "  Elements:";
+	int_or_doubles.visit([](auto value) { std::cout << ' ' << value; });
+	std::cout << '\n';
+
+	int_or_doubles.set(0, 1.5);
+	std::cout << "  After set(0, 1.5): " << std::get<double>(int_or_doubles.at(0)) << ", "
+			  << int_or_doubles.count<double>() << " doubles\n";
+
+	std::vector<NaNBox> boxes {NaNBox(1), NaNBox(2.0), NaNBox(-3), NaNBox(std::nan(""))};
+	std::cout << "  NaN-boxed:";
+	for (NaNBox box : boxes)
+	{
+		if (box.isInt())
+		{
+			std::cout << " int " << box.asInt();
+		}
+		else
+		{
+			std::cout << " double " << box.asDouble();
+		}
+	}
+	std::cout << '\n';
+}
+
+void size_and_tag_scan()
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	constexpr int num_elements {10'000'000};
+	std::mt19937 random(1234);
+	std::bernoulli_distribution is_int(0.5);
+
+	IntOrDoubles variants;
+	CompactVariantVector<int, double> byte_tagged;
+	BitTaggedVariantVector<int, double> bit_tagged;
+	std::vector<NaNBox> nan_boxed;
+	variants.reserve(num_elements);
+	byte_tagged.reserve(num_elements);
+	bit_tagged.reserve(num_elements);
+	nan_boxed.reserve(num_elements);
+	for (int i = 0; i < num_elements; ++i)
+	{
+		if (is_int(random))
+		{
+			variants.push_back(i);
+			byte_tagged.push_back(i);
+			bit_tagged.push_back(i);
+			nan_boxed.push_back(NaNBox(i));
+		}
+		else
+		{
+			variants.push_back(double(i));
+			byte_tagged.push_back(double(i));
+			bit_tagged.push_back(double(i));
+			nan_boxed.push_back(NaNBox(double(i)));
+		}
+	}
+
+	const auto variant_bytes = variants.size() * sizeof(IntOrDouble);
+	auto print_size = [variant_bytes](const char* label, std::size_t bytes) {
+		std::cout << "  " << label << bytes << " bytes, "
+				  << 100 - 100 * static_cast<long long>(bytes) / static_cast<long long>(variant_bytes)
+				  << "% smaller\n";
+	};
+	std::cout << "  std::vector<IntOrDouble>: " << variant_bytes << " bytes\n";
+	print_size("Byte tags:                ", byte_tagged.sizeInBytes());
+	print_size("Bit tags:                 ", bit_tagged.sizeInBytes());
+	print_size("NaN-boxed:                ", nan_boxed.size() * sizeof(NaNBox));
+
+	std::ptrdiff_t counts[3] {};
+	const double variant_ms = milliseconds([&]() {
+		for (const IntOrDouble& value : variants)
+		{
+			counts[0] += std::holds_alternative<int>(value);
+		}
+	});
+	const double byte_ms = milliseconds([&]() { counts[1] = byte_tagged.count<int>(); });
+	const double bit_ms = milliseconds([&]() { counts[2] = bit_tagged.count<int>(); });
+
+	std::cout << "  Count ints, std::vector<IntOrDouble>: " << counts[0] << " in " << variant_ms
+			  << " ms\n";
+	std::cout << "  Count ints, byte tags:                " << counts[1] << " in " << byte_ms
+			  << " ms\n";
+	std::cout << "  Count ints, bit tags:                 " << counts[2] << " in " << bit_ms
+			  << " ms\n";
+}
+
+int main()
+{
+	same_elements_as_variant_cpp();
+	size_and_tag_scan();
+}
@@ -0,0 +1,389 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+/*
+Smaller storage for sequences of variants.
+
+sizeof(std::variant<int, double>) is 16: 8 bytes for the double, 1 byte for
+the index, and 7 bytes of padding to keep the next element's double aligned.
+Storing the indices, here called tags, in an array of their own removes the
+padding. The payloads go in an array of unions, 8 bytes each, and the tags in
+an array of bytes, or of bits when there are few enough types. That is 9 or
+8.125 bytes per element instead of 16.
+
+A scan over only the tags, e.g. counting how many elements are ints, reads
+one byte, or bit, per element instead of 16 bytes. A byte scan is a plain loop
+over uint8_t that the compiler vectorizes, a bit scan is a popcount per 64
+elements.
+
+Payloads are copied in and out with memcpy, so every type must be trivially
+copyable. Elements are returned by value since there is no T object to refer
+to inside the payload array.
+
+For the special case of int32_t or double, NaNBox below squeezes both the tag
+and the payload into 8 bytes.
+*/
+
+enum class TagLayout
+{
+	/// One byte per tag.
+	Bytes,
+	/// As few bits per tag as the number of types allows, packed into 64-bit words.
+	Bits
+};
+
+template <TagLayout Layout, typename... Ts>
+class BasicCompactVariantVector
+{
+	static_assert(sizeof...(Ts) > 0 && sizeof...(Ts) <= 256);
+	static_assert((std::is_trivially_copyable_v<Ts> && ...));
+
+public:
+	using variant_type = std::variant<Ts...>;
+
+	template <typename T>
+	static constexpr std::uint8_t type_index = []() {
+		std::uint8_t index {0};
+		((std::is_same_v<T, Ts> ? false : (++index, true)) && ...);
+		return index;
+	}();
+
+	/// Number of bits per tag. Always a power of two so that no tag straddles
+	/// two words.
+	static constexpr int TAG_BITS = []() {
+		if constexpr (Layout == TagLayout::Bytes)
+		{
+			return 8;
+		}
+		int bits {1};
+		while ((std::size_t {1} << bits) < sizeof...(Ts))
+		{
+			bits *= 2;
+		}
+		return bits;
+	}();
+
+	std::ptrdiff_t size() const
+	{
+		return m_size;
+	}
+
+	bool empty() const
+	{
+		return m_size == 0;
+	}
+
+	/// Bytes used by the elements, not counting unused capacity.
+	std::size_t sizeInBytes() const
+	{
+		const std::size_t payload_bytes = static_cast<std::size_t>(m_size) * sizeof(Payload);
+		if constexpr (Layout == TagLayout::Bytes)
+		{
+			return payload_bytes + m_tags.size();
+		}
+		else
+		{
+			return payload_bytes + m_tag_words.size() * sizeof(std::uint64_t);
+		}
+	}
+
+	void reserve(std::ptrdiff_t capacity)
+	{
+		m_payloads.reserve(static_cast<std::size_t>(capacity));
+		if constexpr (Layout == TagLayout::Bytes)
+		{
+			m_tags.reserve(static_cast<std::size_t>(capacity));
+		}
+		else
+		{
+			m_tag_words.reserve(static_cast<std::size_t>(capacity / TAGS_PER_WORD + 1));
+		}
+	}
+
+	template <typename T>
+	void push_back(T value)
+		requires(std::is_same_v<T, Ts> || ...)
+	{
+		Payload payload;
+		std::memcpy(payload.bytes, &value, sizeof(T));
+		m_payloads.push_back(payload);
+		pushTag(type_index<T>);
+		++m_size;
+	}
+
+	void push_back(const variant_type& value)
+	{
+		std::visit([this](auto alternative) { push_back(alternative); }, value);
+	}
+
+	std::size_t index(std::ptrdiff_t position) const
+	{
+		assert(position >= 0 && position < m_size);
+		if constexpr (Layout == TagLayout::Bytes)
+		{
+			return m_tags[static_cast<std::size_t>(position)];
+		}
+		else
+		{
+			const auto word_index = static_cast<std::size_t>(position / TAGS_PER_WORD);
+			const std::uint64_t word = m_tag_words[word_index];
+			return (word >> (position % TAGS_PER_WORD * TAG_BITS)) & TAG_MASK;
+		}
+	}
+
+	template <typename T>
+	bool holds(std::ptrdiff_t position) const
+	{
+		return index(position) == type_index<T>;
+	}
+
+	/// The element at 'position', which must be a T.
+	template <typename T>
+	T get(std::ptrdiff_t position) const
+	{
+		assert(holds<T>(position));
+		T value;
+		std::memcpy(&value, m_payloads[static_cast<std::size_t>(position)].bytes, sizeof(T));
+		return value;
+	}
+
+	/// Replace the element at 'position', possibly with one of a different type.
+	template <typename T>
+	void set(std::ptrdiff_t position, T value)
+		requires(std::is_same_v<T, Ts> || ...)
+	{
+		std::memcpy(m_payloads[static_cast<std::size_t>(position)].bytes, &value, sizeof(T));
+		setTag(position, type_index<T>);
+	}
+
+	variant_type at(std::ptrdiff_t position) const
+	{
+		return atImpl(position, std::index_sequence_for<Ts...> {});
+	}
+
+	/// Number of elements of type T. Only reads the tags.
+	template <typename T>
+	std::ptrdiff_t count() const
+	{
+		constexpr std::uint8_t tag = type_index<T>;
+		if constexpr (Layout == TagLayout::Bytes)
+		{
+			// Count in blocks of at most 255 tags so that the per-block count
+			// fits in a byte. A byte-sized counter lets the compiler compare and
+			// add 16, 32, or 64 tags per instruction.
+			std::ptrdiff_t num_matching {0};
+			const std::uint8_t* tags = m_tags.data();
+			for (std::ptrdiff_t block = 0; block < m_size; block += 255)
+			{
+				const std::ptrdiff_t block_end = std::min(block + 255, m_size);
+				std::uint8_t block_matching {0};
+				for (std::ptrdiff_t position = block; position < block_end; ++position)
+				{
+					block_matching += tags[position] == tag;
+				}
+				num_matching += block_matching;
+			}
+			return num_matching;
+		}
+		else if constexpr (TAG_BITS == 1)
+		{
+			// The set bits are the elements of the second type. Unused bits in
+			// the last word are always zero.
+			std::ptrdiff_t num_set {0};
+			for (std::uint64_t word : m_tag_words)
+			{
+				num_set += std::popcount(word);
+			}
+			return tag == 1 ? num_set : m_size - num_set;
+		}
+		else
+		{
+			std::ptrdiff_t num_matching {0};
+			for (std::ptrdiff_t position = 0; position < m_size; ++position)
+			{
+				num_matching += index(position) == tag;
+			}
+			return num_matching;
+		}
+	}
+
+	/// Call 'visitor(element)' for every element in order.
+	template <typename Visitor>
+	void visit(Visitor&& visitor) const
+	{
+		for (std::ptrdiff_t position = 0; position < m_size; ++position)
+		{
+			visitAt(position, visitor, std::index_sequence_for<Ts...> {});
+		}
+	}
+
+	/// Call 'visitor(element)' for every element of type T, in order.
+	template <typename T, typename Visitor>
+	void forEach(Visitor&& visitor) const
+	{
+		for (std::ptrdiff_t position = 0; position < m_size; ++position)
+		{
+			if (holds<T>(position))
+			{
+				visitor(get<T>(position));
+			}
+		}
+	}
+
+private:
+	static constexpr std::size_t PAYLOAD_SIZE {std::max({sizeof(Ts)...})};
+	static constexpr std::size_t PAYLOAD_ALIGNMENT {std::max({alignof(Ts)...})};
+	static constexpr std::ptrdiff_t TAGS_PER_WORD {64 / TAG_BITS};
+	static constexpr std::uint64_t TAG_MASK {(std::uint64_t {1} << TAG_BITS) - 1};
+
+	struct alignas(PAYLOAD_ALIGNMENT) Payload
+	{
+		unsigned char bytes[PAYLOAD_SIZE];
+	};
+
+	void pushTag(std::uint8_t tag)
+	{
+		if constexpr (Layout == TagLayout::Bytes)
+		{
+			m_tags.push_back(tag);
+		}
+		else
+		{
+			if (m_size % TAGS_PER_WORD == 0)
+			{
+				m_tag_words.push_back(0);
+			}
+			m_tag_words.back() |= std::uint64_t {tag} << (m_size % TAGS_PER_WORD * TAG_BITS);
+		}
+	}
+
+	void setTag(std::ptrdiff_t position, std::uint8_t tag)
+	{
+		if constexpr (Layout == TagLayout::Bytes)
+		{
+			m_tags[static_cast<std::size_t>(position)] = tag;
+		}
+		else
+		{
+			const auto word_index = static_cast<std::size_t>(position / TAGS_PER_WORD);
+			std::uint64_t& word = m_tag_words[word_index];
+			const int shift = static_cast<int>(position % TAGS_PER_WORD * TAG_BITS);
+			word = (word & ~(TAG_MASK << shift)) | (std::uint64_t {tag} << shift);
+		}
+	}
+
+	template <std::size_t... Is>
+	variant_type atImpl(std::ptrdiff_t position, std::index_sequence<Is...>) const
+	{
+		variant_type result;
+		const std::size_t tag = index(position);
+		((tag == Is && (result.template emplace<Is>(get<Ts>(position)), true)) || ...);
+		return result;
+	}
+
+	template <typename Visitor, std::size_t... Is>
+	void visitAt(std::ptrdiff_t position, Visitor& visitor, std::index_sequence<Is...>) const
+	{
+		const std::size_t tag = index(position);
+		((tag == Is && (visitor(get<Ts>(position)), true)) || ...);
+	}
+
+private:
+	std::vector<Payload> m_payloads;
+	std::vector<std::uint8_t> m_tags;
+	std::vector<std::uint64_t> m_tag_words;
+	std::ptrdiff_t m_size {0};
+};
+
+template <typename... Ts>
+using CompactVariantVector = BasicCompactVariantVector<TagLayout::Bytes, Ts...>;
+
+template <typename... Ts>
+using BitTaggedVariantVector = BasicCompactVariantVector<TagLayout::Bits, Ts...>;
+
+/*
+An int32_t or a double in 8 bytes.
+
+A double is a NaN when all exponent bits are set and the mantissa is non-zero.
+The hardware only ever produces one NaN bit pattern, the canonical quiet NaN,
+which leaves the 2^51 other quiet NaN patterns free to encode something else.
+Here an int32_t is stored in the low 32 bits of a quiet NaN with a marker in
+the bits above it. Every NaN double is stored as the canonical NaN so that it
+can't be mistaken for an int.
+
+Use in a plain std::vector<NaNBox>, half the size of
+std::vector<std::variant<int32_t, double>>.
+*/
+
+class NaNBox
+{
+public:
+	NaNBox()
+		: NaNBox(0.0)
+	{
+	}
+
+	NaNBox(double value)
+		: m_bits(std::bit_cast<std::uint64_t>(
+			  std::isnan(value) ? std::numeric_limits<double>::quiet_NaN() : value))
+	{
+	}
+
+	NaNBox(std::int32_t value)
+		: m_bits(INT_MARKER | static_cast<std::uint32_t>(value))
+	{
+	}
+
+	bool isInt() const
+	{
+		return (m_bits & MARKER_MASK) == INT_MARKER;
+	}
+
+	bool isDouble() const
+	{
+		return !isInt();
+	}
+
+	std::int32_t asInt() const
+	{
+		assert(isInt());
+		return static_cast<std::int32_t>(static_cast<std::uint32_t>(m_bits));
+	}
+
+	double asDouble() const
+	{
+		assert(isDouble());
+		return std::bit_cast<double>(m_bits);
+	}
+
+	std::variant<std::int32_t, double> toVariant() const
+	{
+		if (isInt())
+		{
+			return asInt();
+		}
+		return asDouble();
+	}
+
+private:
+	// Sign bit clear, all exponent bits set, quiet bit set, and one more bit set
+	// so that the pattern differs from the canonical quiet NaN 0x7FF8'0000'0000'0000.
+	static constexpr std::uint64_t INT_MARKER {0x7FFC'0000'0000'0000};
+	static constexpr std::uint64_t MARKER_MASK {0xFFFF'FFFF'0000'0000};
+
+	std::uint64_t m_bits;
+};
+
+static_assert(sizeof(NaNBox) == 8);
@@ -0,0 +1,227 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+/*
+Visitation of a single std::variant without going through std::visit.
+
+std::visit is specified for any number of variants, and depending on the
+standard library version it is implemented as a table of function pointers,
+which the compiler can't inline through, or as a switch. 'fast_visit' handles
+only one variant and always produces code the optimizer understands:
+
+- For up to 8 alternatives a fold expression over the alternatives' indices,
+  in the style of 'for_each_arg' in "Fold Expression.md", comparing the index
+  with each one and calling the visitor directly. GCC compiles the comparisons
+  like a switch, and every call can be inlined.
+- For more alternatives a table of function pointers, one per alternative,
+  built by expanding the index pack.
+
+'fast_visit_batched' visits a range of variants a batch at a time. Each batch
+is first sorted by type into small position lists, then every list is visited
+with a loop that calls the same visitor overload for every element. The
+per-element indirect jump, which is what mispredicts when the types are
+interleaved, becomes one predictable loop per type. When the types already come
+in long runs the extra pass over the batch is pure overhead, there std::visit
+or fast_visit is faster.
+*/
+
+namespace fast_visit_detail
+{
+	template <typename Variant>
+	using Alternatives = std::variant_size<std::remove_cvref_t<Variant>>;
+
+	template <std::size_t I, typename Variant>
+	using AlternativeRef = decltype(std::get<I>(std::declval<Variant>()));
+
+	template <typename Visitor, typename Variant, std::size_t I>
+	using ResultOf = std::invoke_result_t<Visitor, AlternativeRef<I, Variant>>;
+
+	/// Every alternative must produce the same type, as with std::visit.
+	template <typename Visitor, typename Variant, std::size_t... Is>
+	constexpr bool sameResultTypes(std::index_sequence<Is...>)
+	{
+		return (std::is_same_v<ResultOf<Visitor, Variant, 0>, ResultOf<Visitor, Variant, Is>> && ...);
+	}
+
+	template <std::size_t I, typename Visitor, typename Variant>
+	decltype(auto) invokeAlternative(Visitor&& visitor, Variant&& variant)
+	{
+		// The index has already been checked, get_if skips the check std::get does.
+		return std::invoke(
+			std::forward<Visitor>(visitor), std::move(*std::get_if<I>(&variant)));
+	}
+
+	template <std::size_t I, typename Visitor, typename Variant>
+	decltype(auto) invokeAlternativeLvalue(Visitor&& visitor, Variant& variant)
+	{
+		return std::invoke(std::forward<Visitor>(visitor), *std::get_if<I>(&variant));
+	}
+
+	template <std::size_t I, typename Visitor, typename Variant>
+	decltype(auto) invoke(Visitor&& visitor, Variant&& variant)
+	{
+		if constexpr (std::is_lvalue_reference_v<Variant>)
+		{
+			return invokeAlternativeLvalue<I>(std::forward<Visitor>(visitor), variant);
+		}
+		else
+		{
+			return invokeAlternative<I>(std::forward<Visitor>(visitor), std::move(variant));
+		}
+	}
+
+	constexpr std::size_t FOLD_LIMIT {8};
+
+	/// Where the fold stores the result. References are stored as pointers.
+	template <typename Result>
+	using Stored = std::conditional_t<
+		std::is_reference_v<Result>, std::remove_reference_t<Result>*, Result>;
+
+	/// 'index == I && visit alternative I' for every I, joined with ||. GCC
+	/// turns the chain of comparisons into a switch, a jump table once there
+	/// are enough alternatives, and every alternative is called directly and
+	/// can be inlined.
+	template <typename Visitor, typename Variant, std::size_t... Is>
+	decltype(auto) visitWithFold(Visitor&& visitor, Variant&& variant, std::index_sequence<Is...>)
+	{
+		using Result = ResultOf<Visitor, Variant, 0>;
+		const std::size_t index = variant.index();
+		if constexpr (std::is_void_v<Result>)
+		{
+			((index == Is &&
+			  (invoke<Is>(std::forward<Visitor>(visitor), std::forward<Variant>(variant)), true)) ||
+			 ...);
+		}
+		else
+		{
+			// Exactly one alternative matches, so the result is always set.
+			std::optional<Stored<Result>> result;
+			auto store = [&result](auto&& value) {
+				if constexpr (std::is_reference_v<Result>)
+				{
+					result.emplace(std::addressof(value));
+				}
+				else
+				{
+					result.emplace(std::forward<decltype(value)>(value));
+				}
+			};
+			((index == Is &&
+			  (store(invoke<Is>(std::forward<Visitor>(visitor), std::forward<Variant>(variant))),
+			   true)) ||
+			 ...);
+			if constexpr (std::is_reference_v<Result>)
+			{
+				return static_cast<Result>(**result);
+			}
+			else
+			{
+				// A prvalue, so that decltype(auto) deduces Result and not a
+				// reference to the local.
+				return Result(std::move(*result));
+			}
+		}
+	}
+
+	template <typename Visitor, typename Variant, std::size_t... Is>
+	decltype(auto) visitWithTable(Visitor&& visitor, Variant&& variant, std::index_sequence<Is...>)
+	{
+		using Result = ResultOf<Visitor, Variant, 0>;
+		using Function = Result (*)(Visitor&&, Variant&&);
+		static constexpr std::array<Function, sizeof...(Is)> table {
+			&invoke<Is, Visitor, Variant>...};
+		return table[variant.index()](std::forward<Visitor>(visitor), std::forward<Variant>(variant));
+	}
+}
+
+/// Same as 'std::visit(visitor, variant)' for a single variant.
+template <typename Visitor, typename Variant>
+decltype(auto) fast_visit(Visitor&& visitor, Variant&& variant)
+{
+	using namespace fast_visit_detail;
+	constexpr std::size_t N = Alternatives<Variant>::value;
+	static_assert(
+		sameResultTypes<Visitor, Variant>(std::make_index_sequence<N> {}),
+		"fast_visit requires the visitor to return the same type for every alternative.");
+
+	if (variant.valueless_by_exception())
+	{
+		throw std::bad_variant_access();
+	}
+
+	if constexpr (N <= FOLD_LIMIT)
+	{
+		return visitWithFold(
+			std::forward<Visitor>(visitor), std::forward<Variant>(variant),
+			std::make_index_sequence<N> {});
+	}
+	else
+	{
+		return visitWithTable(
+			std::forward<Visitor>(visitor), std::forward<Variant>(variant),
+			std::make_index_sequence<N> {});
+	}
+}
+
+/// Call 'visitor' with every variant in the range [first, last), grouped by
+/// type within batches of 'BatchSize' elements. The order in which elements
+/// are visited is only preserved among elements of the same type. The
+/// visitor's return value is ignored. The iterators must be random access, the
+/// elements are visited by their offset within the batch.
+template <std::size_t BatchSize = 256, std::random_access_iterator Iterator, typename Visitor>
+void fast_visit_batched(Iterator first, Iterator last, Visitor&& visitor)
+{
+	using Variant = std::remove_reference_t<std::iter_reference_t<Iterator>>;
+	constexpr std::size_t N = fast_visit_detail::Alternatives<Variant>::value;
+	static_assert(BatchSize <= 65536, "Batch positions are stored as 16-bit integers.");
+
+	// positions[type][0..counts[type]) are the batch offsets of the elements
+	// of that type. Filled without any data-dependent branch.
+	std::uint16_t positions[N][BatchSize];
+	std::size_t counts[N];
+
+	while (first != last)
+	{
+		std::fill(std::begin(counts), std::end(counts), 0);
+		Iterator batch_begin = first;
+		std::size_t batch_size {0};
+		for (; first != last && batch_size < BatchSize; ++first, ++batch_size)
+		{
+			const std::size_t type = first->index();
+			if (type == std::variant_npos)
+			{
+				throw std::bad_variant_access();
+			}
+			positions[type][counts[type]++] = static_cast<std::uint16_t>(batch_size);
+		}
+
+		[&]<std::size_t... Is>(std::index_sequence<Is...>) {
+			(
+				[&]() {
+					for (std::size_t i = 0; i < counts[Is]; ++i)
+					{
+						auto& variant = batch_begin[positions[Is][i]];
+						std::invoke(visitor, *std::get_if<Is>(&variant));
+					}
+				}(),
+				...);
+		}(std::make_index_sequence<N> {});
+	}
+}
+
+template <std::size_t BatchSize = 256, typename Range, typename Visitor>
+void fast_visit_batched(Range& range, Visitor&& visitor)
+{
+	fast_visit_batched<BatchSize>(std::begin(range), std::end(range), std::forward<Visitor>(visitor));
+}
@@ -0,0 +1,185 @@
+/*
+Compares std::visit against fast_visit and fast_visit_batched on a vector of
+variants, with the types either sorted, so that the dispatch is predictable,
+or randomly interleaved. IntOrDouble goes through the fold in fast_visit,
+Wide, with 12 alternatives, through the table of function pointers.
+
+The loops are in noinline functions between place_flag markers, like in
+variant.cpp, so that the dispatch code is easy to find in the disassembly:
+  objdump -d --no-show-raw-insn -C build/variant/fast_visit_bench | less
+
+Build in Release mode, the dispatch is meaningless without optimization:
+  cmake -S . -B build -DCMAKE_BUILD_TYPE=Release
+  cmake --build build --target fast_visit_bench
+
+Run a subset, e.g. only the interleaved runs:
+  ./build/variant/fast_visit_bench --benchmark_filter=Interleaved
+*/
+
+#include "fast_visit.h"
+
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <variant>
+#include <vector>
+
+volatile int sink_int {0};
+
+__attribute((noinline)) void consume(int i)
+{
+	sink_int = i;
+}
+
+template <int flag>
+__attribute((noinline)) void place_flag()
+{
+	consume(flag);
+}
+
+using IntOrDouble = std::variant<int, double>;
+
+// 12 alternatives, more than fast_visit uses the fold for.
+using Wide = std::variant<
+	char, signed char, unsigned char, short, unsigned short, int, unsigned int, long,
+	unsigned long, long long, float, double>;
+
+// Each alternative does something different so that the compiler can't merge
+// the cases.
+struct Accumulate
+{
+	long long int_sum {0};
+	double double_sum {0.0};
+
+	void operator()(int i)
+	{
+		int_sum += i;
+	}
+
+	void operator()(double d)
+	{
+		double_sum += d * 0.5;
+	}
+
+	template <typename T>
+	void operator()(T value)
+	{
+		if constexpr (std::is_floating_point_v<T>)
+		{
+			double_sum += static_cast<double>(value);
+		}
+		else
+		{
+			int_sum += static_cast<long long>(value) * static_cast<long long>(sizeof(T));
+		}
+	}
+};
+
+enum class Order
+{
+	Sorted,
+	Interleaved
+};
+
+template <typename Variant>
+std::vector<Variant> makeVariants(std::ptrdiff_t size, Order order)
+{
+	constexpr int num_types {static_cast<int>(std::variant_size_v<Variant>)};
+	std::mt19937 random(1234);
+	std::uniform_int_distribution<int> type_of(0, num_types - 1);
+
+	std::vector<Variant> variants;
+	variants.reserve(static_cast<std::size_t>(size));
+	for (std::ptrdiff_t i = 0; i < size; ++i)
+	{
+		const int type = order == Order::Sorted ? static_cast<int>(i * num_types / size)
+												: type_of(random);
+		[&]<std::size_t... Is>(std::index_sequence<Is...>) {
+			((type == static_cast<int>(Is) &&
+			  (variants.emplace_back(
+				   std::in_place_index<Is>,
+				   static_cast<std::variant_alternative_t<Is, Variant>>(i % 100)),
+			   true)) ||
+			 ...);
+		}(std::make_index_sequence<num_types> {});
+	}
+	return variants;
+}
+
+template <typename Variant>
+__attribute((noinline)) void withStdVisit(std::vector<Variant>& variants, Accumulate& accumulate)
+{
+	place_flag<1>();
+	for (Variant& variant : variants)
+	{
+		std::visit(accumulate, variant);
+	}
+	place_flag<2>();
+}
+
+template <typename Variant>
+__attribute((noinline)) void withFastVisit(std::vector<Variant>& variants, Accumulate& accumulate)
+{
+	place_flag<3>();
+	for (Variant& variant : variants)
+	{
+		fast_visit(accumulate, variant);
+	}
+	place_flag<4>();
+}
+
+template <typename Variant>
+__attribute((noinline)) void withFastVisitBatched(
+	std::vector<Variant>& variants, Accumulate& accumulate)
+{
+	place_flag<5>();
+	fast_visit_batched(variants, accumulate);
+	place_flag<6>();
+}
+
+template <typename Variant, Order order, auto visitAll>
+void BM_Visit(benchmark::State& state)
+{
+	std::vector<Variant> variants = makeVariants<Variant>(state.range(0), order);
+
+	// Every variant must give the same sums as std::visit. The values are
+	// small integers and halves, so the double sums are exact in any order.
+	Accumulate expected;
+	withStdVisit(variants, expected);
+	Accumulate actual;
+	visitAll(variants, actual);
+	if (actual.int_sum != expected.int_sum || actual.double_sum != expected.double_sum)
+	{
+		state.SkipWithError("Result differs from std::visit.");
+		return;
+	}
+
+	for (auto _ : state)
+	{
+		Accumulate accumulate;
+		visitAll(variants, accumulate);
+		benchmark::DoNotOptimize(accumulate);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+#define VISIT_BENCHMARKS(Variant, order)                                                        \
+	BENCHMARK(BM_Visit<Variant, Order::order, withStdVisit<Variant>>)                           \
+		->Name("StdVisit/" #Variant "/" #order)                                                 \
+		->RangeMultiplier(16)                                                                   \
+		->Range(1 << 10, 1 << 22);                                                              \
+	BENCHMARK(BM_Visit<Variant, Order::order, withFastVisit<Variant>>)                          \
+		->Name("FastVisit/" #Variant "/" #order)                                                \
+		->RangeMultiplier(16)                                                                   \
+		->Range(1 << 10, 1 << 22);                                                              \
+	BENCHMARK(BM_Visit<Variant, Order::order, withFastVisitBatched<Variant>>)                   \
+		->Name("FastVisitBatched/" #Variant "/" #order)                                         \
+		->RangeMultiplier(16)                                                                   \
+		->Range(1 << 10, 1 << 22);
+
+VISIT_BENCHMARKS(IntOrDouble, Sorted)
+VISIT_BENCHMARKS(IntOrDouble, Interleaved)
+VISIT_BENCHMARKS(Wide, Sorted)
+VISIT_BENCHMARKS(Wide, Interleaved)
+
+BENCHMARK_MAIN();
@@ -0,0 +1,145 @@
+#include "poly_vector.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <variant>
+#include <vector>
+
+volatile int sink_int {0};
+volatile double sink_double {0.0};
+
+__attribute((noinline)) void consume(int i)
+{
+	sink_int = i;
+}
+
+__attribute((noinline)) void consume(double i)
+{
+	sink_double = i;
+}
+
+template <int flag>
+__attribute((noinline)) void place_flag()
+{
+	consume(flag);
+}
+
+using IntOrDouble = std::variant<int, double>;
+using IntOrDoubles = std::vector<IntOrDouble>;
+using IntOrDoublePolyVector = PolyVector<int, double>;
+
+// Same as in variant.cpp.
+struct Process
+{
+	void operator()(int i)
+	{
+		consume(i);
+	}
+
+	void operator()(double d)
+	{
+		consume(d);
+	}
+};
+
+// Not calling consume per element, so that the per-type loops can be inlined
+// and vectorized.
+struct Accumulate
+{
+	long long int_sum {0};
+	double double_sum {0.0};
+
+	void operator()(int i)
+	{
+		int_sum += i;
+	}
+
+	void operator()(double d)
+	{
+		double_sum += d;
+	}
+};
+
+template <typename Function>
+double milliseconds(Function function)
+{
+	const auto start = std::chrono::steady_clock::now();
+	function();
+	const auto stop = std::chrono::steady_clock::now();
+	return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+void same_elements_as_variant_cpp()
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	IntOrDoublePolyVector int_or_doubles {1, 2.0, 3, 4.0, 5, 6, 7, 8.0};
+	std::cout << "  " << int_or_doubles.count<int>() << " ints, "
+			  << int_or_doubles.count<double>() << " doubles\n";
+
+	place_flag<1>();
+	int_or_doubles.visit(Process());
+	place_flag<2>();
+
+	// Positions are stable and map back to the element that was added there.
+	std::cout << "  In insertion order:";
+	int_or_doubles.visitInOrder([](auto value) { std::cout << ' ' << value; });
+	std::cout << '\n';
+	std::cout << "  Element 3 is a " << (int_or_doubles.holds<double>(3) ? "double" : "int")
+			  << " with value " << int_or_doubles.get<double>(3) << '\n';
+}
+
+void interleaved_types()
+{
+	std::cout << "\n# " << __FUNCTION__ << '\n';
+
+	// Randomly interleaved, the worst case for the branch predictor.
+	std::mt19937 random(1234);
+	std::bernoulli_distribution is_int(0.5);
+	IntOrDoubles variants;
+	IntOrDoublePolyVector poly;
+	for (int i = 0; i < 10'000'000; ++i)
+	{
+		if (is_int(random))
+		{
+			variants.push_back(i);
+			poly.push_back(i);
+		}
+		else
+		{
+			variants.push_back(double(i));
+			poly.push_back(double(i));
+		}
+	}
+
+	Accumulate variant_sums;
+	const double variant_ms = milliseconds([&]() {
+		for (IntOrDouble& int_or_double : variants)
+		{
+			std::visit(variant_sums, int_or_double);
+		}
+	});
+
+	Accumulate poly_sums;
+	const double poly_ms = milliseconds([&]() { poly.visit(poly_sums); });
+
+	std::cout << "  std::visit:        " << variant_ms << " ms\n";
+	std::cout << "  PolyVector::visit: " << poly_ms << " ms\n";
+	std::cout << "  Same result: "
+			  << (variant_sums.int_sum == poly_sums.int_sum &&
+				  variant_sums.double_sum == poly_sums.double_sum)
+			  << '\n';
+	std::cout << "  Bytes, std::vector<std::variant>: " << variants.size() * sizeof(IntOrDouble)
+			  << '\n';
+	std::cout << "  Bytes, PolyVector (with index):   "
+			  << poly.count<int>() * sizeof(int) + poly.count<double>() * sizeof(double) +
+			poly.size() * sizeof(IntOrDoublePolyVector::Location)
+			  << '\n';
+}
+
+int main()
+{
+	same_elements_as_variant_cpp();
+	interleaved_types();
+}
@@ -0,0 +1,234 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+/*
+A sequence of values of a fixed set of types, stored one array per type.
+
+Visiting a std::vector<std::variant<int, double>> dispatches on the type of
+every element. When the types are interleaved, e.g. {1, 2.0, 3, 4.0}, the
+branch predictor can't predict which function to call next and much of the
+time goes to mispredictions. PolyVector keeps all ints in one array and all
+doubles in another, so 'visit' becomes one tight loop per type with no
+per-element dispatch. The compiler can inline the visitor and vectorize each
+loop.
+
+Elements are still addressable by the position they were added at. A
+separate array maps each position to a type and an offset into that type's
+array. Positions are stable since elements are never removed or moved
+between arrays.
+*/
+
+template <typename... Ts>
+class PolyVector
+{
+	static_assert(sizeof...(Ts) > 0);
+
+public:
+	using variant_type = std::variant<Ts...>;
+
+	static constexpr std::size_t NUM_TYPES {sizeof...(Ts)};
+
+	/// Index of T in Ts.
+	template <typename T>
+	static constexpr std::size_t type_index = []() {
+		std::size_t index {0};
+		((std::is_same_v<T, Ts> ? false : (++index, true)) && ...);
+		return index;
+	}();
+
+	/// Where an element is stored, the type and the offset into that type's array.
+	struct Location
+	{
+		std::uint32_t type;
+		std::uint32_t offset;
+	};
+
+	PolyVector() = default;
+
+	PolyVector(std::initializer_list<variant_type> values)
+	{
+		for (const variant_type& value : values)
+		{
+			push_back(value);
+		}
+	}
+
+	std::ptrdiff_t size() const
+	{
+		return std::ssize(m_locations);
+	}
+
+	bool empty() const
+	{
+		return m_locations.empty();
+	}
+
+	/// Number of elements of type T.
+	template <typename T>
+	std::ptrdiff_t count() const
+	{
+		return std::ssize(array<T>());
+	}
+
+	template <typename T>
+	void push_back(T value)
+		requires(std::is_same_v<T, Ts> || ...)
+	{
+		std::vector<T>& values = array<T>();
+		const auto offset = static_cast<std::uint32_t>(values.size());
+		m_locations.push_back({static_cast<std::uint32_t>(type_index<T>), offset});
+		values.push_back(std::move(value));
+	}
+
+	void push_back(const variant_type& value)
+	{
+		std::visit([this](const auto& alternative) { push_back(alternative); }, value);
+	}
+
+	/// The type index, as in std::variant::index, of the element at 'position'.
+	std::size_t index(std::ptrdiff_t position) const
+	{
+		return location(position).type;
+	}
+
+	Location location(std::ptrdiff_t position) const
+	{
+		assert(position >= 0 && position < size());
+		return m_locations[static_cast<std::size_t>(position)];
+	}
+
+	template <typename T>
+	bool holds(std::ptrdiff_t position) const
+	{
+		return index(position) == type_index<T>;
+	}
+
+	/// The element at 'position', which must be a T.
+	template <typename T>
+	T& get(std::ptrdiff_t position)
+	{
+		const Location where = location(position);
+		assert(where.type == type_index<T>);
+		return array<T>()[where.offset];
+	}
+
+	template <typename T>
+	const T& get(std::ptrdiff_t position) const
+	{
+		const Location where = location(position);
+		assert(where.type == type_index<T>);
+		return array<T>()[where.offset];
+	}
+
+	/// A copy of the element at 'position'.
+	variant_type at(std::ptrdiff_t position) const
+	{
+		variant_type result;
+		visitAt(position, [&result](const auto& value) { result = value; });
+		return result;
+	}
+
+	/// All elements of type T, contiguous.
+	template <typename T>
+	std::span<T> elements()
+	{
+		return array<T>();
+	}
+
+	template <typename T>
+	std::span<const T> elements() const
+	{
+		return array<T>();
+	}
+
+	/// Call 'visitor(element)' for every element, grouped by type: first all
+	/// elements of the first type, in insertion order, then all elements of the
+	/// second type, and so on. No per-element dispatch.
+	template <typename Visitor>
+	void visit(Visitor&& visitor)
+	{
+		(visitArray(array<Ts>(), visitor), ...);
+	}
+
+	template <typename Visitor>
+	void visit(Visitor&& visitor) const
+	{
+		(visitArray(array<Ts>(), visitor), ...);
+	}
+
+	/// Call 'visitor(element)' for every element in insertion order. This
+	/// dispatches per element, just like std::visit, and is only here for the
+	/// algorithms that need the order.
+	template <typename Visitor>
+	void visitInOrder(Visitor&& visitor)
+	{
+		for (std::ptrdiff_t position = 0; position < size(); ++position)
+		{
+			visitAt(position, visitor);
+		}
+	}
+
+	/// Call 'visitor(element)' for the element at 'position'.
+	template <typename Visitor>
+	void visitAt(std::ptrdiff_t position, Visitor&& visitor)
+	{
+		const Location where = location(position);
+		visitAtImpl(where, visitor, std::index_sequence_for<Ts...> {});
+	}
+
+	template <typename Visitor>
+	void visitAt(std::ptrdiff_t position, Visitor&& visitor) const
+	{
+		const Location where = location(position);
+		visitAtImpl(where, visitor, std::index_sequence_for<Ts...> {});
+	}
+
+private:
+	template <typename T>
+	std::vector<T>& array()
+	{
+		return std::get<std::vector<T>>(m_arrays);
+	}
+
+	template <typename T>
+	const std::vector<T>& array() const
+	{
+		return std::get<std::vector<T>>(m_arrays);
+	}
+
+	template <typename Array, typename Visitor>
+	static void visitArray(Array& values, Visitor& visitor)
+	{
+		for (auto& value : values)
+		{
+			visitor(value);
+		}
+	}
+
+	template <typename Visitor, std::size_t... Is>
+	void visitAtImpl(Location where, Visitor& visitor, std::index_sequence<Is...>)
+	{
+		// Fold over ||, stops at the first matching type.
+		((where.type == Is && (visitor(std::get<Is>(m_arrays)[where.offset]), true)) || ...);
+	}
+
+	template <typename Visitor, std::size_t... Is>
+	void visitAtImpl(Location where, Visitor& visitor, std::index_sequence<Is...>) const
+	{
+		((where.type == Is && (visitor(std::get<Is>(m_arrays)[where.offset]), true)) || ...);
+	}
+
+private:
+	std::tuple<std::vector<Ts>...> m_arrays;
+	std::vector<Location> m_locations;
+};